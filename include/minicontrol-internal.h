@@ -17,6 +17,7 @@
 #ifndef _MINICTRL_INTERNAL_H_
 #define _MINICTRL_INTERNAL_H_
 
+#include <sys/types.h>
 #include <dbus/dbus.h>
 #include "minicontrol-type.h"
 
@@ -28,20 +29,161 @@
 #define MINICTRL_DBUS_SIG_STOP "minicontrol_stop"
 #define MINICTRL_DBUS_SIG_RESIZE "minicontrol_resize"
 #define MINICTRL_DBUS_SIG_RUNNING_REQ "minicontrol_running_request"
+#define MINICTRL_DBUS_SIG_PRIORITY "minicontrol_priority"
+#define MINICTRL_DBUS_SIG_BATCH "minicontrol_batch"
+
+/* maximum number of records in one batch signal */
+#define MINICTRL_BATCH_MAX 32
+
+enum {
+	MINICTRL_RESOURCE_PROVIDER = 0,
+	MINICTRL_RESOURCE_HANDLE,
+	MINICTRL_RESOURCE_CONNECTION,
+	MINICTRL_RESOURCE_MATCH,
+	MINICTRL_RESOURCE_PLUG_NAME,
+	MINICTRL_RESOURCE_FD,
+};
+
+/* slots of the shared state table */
+#define MINICTRL_STATE_SLOTS 128
+
+#define MINICTRL_JOURNAL_BUS_ID_MAX 40
+#define MINICTRL_JOURNAL_SENDER_MAX 64
+#define MINICTRL_JOURNAL_CATEGORY_MAX 64
+
+/* state of a provider as the monitor journal keeps it */
+typedef struct _minictrl_journal_entry {
+	char name[MINICONTROL_STATE_NAME_MAX];
+	char sender[MINICTRL_JOURNAL_SENDER_MAX];
+	char category[MINICTRL_JOURNAL_CATEGORY_MAX];
+	unsigned int width;
+	unsigned int height;
+	minicontrol_priority_e priority;
+} minictrl_journal_entry;
+
+enum {
+	MINICTRL_SHARED_STATE_FREE = 0,
+	MINICTRL_SHARED_STATE_READY,
+	MINICTRL_SHARED_STATE_RUNNING,
+	MINICTRL_SHARED_STATE_STOPPED, /* gone, STOP was sent for it */
+};
+
+/* priority of a value on the bus no library sends */
+#define MINICTRL_PRIORITY_FALLBACK MINICONTROL_PRIORITY_LOW
+
+int _minictrl_priority_valid(unsigned int value);
 
 typedef struct _minictrl_sig_handle minictrl_sig_handle;
+typedef struct _minictrl_name_watch minictrl_name_watch;
 
 int _minictrl_provider_message_send(const char *sig_name, const char *svr_name,
 				unsigned int witdh, unsigned int height,
 				minicontrol_priority_e priority);
 
+int _minictrl_provider_start_message_send(const char *svr_name,
+				unsigned int witdh, unsigned int height,
+				minicontrol_priority_e priority,
+				const char *category);
+
+int _minictrl_provider_priority_message_send(const char *svr_name,
+				minicontrol_priority_e priority);
+
+/* sends events of several providers as one signal, strings of events
+ * are only read during the call */
+int _minictrl_provider_batch_message_send(const minicontrol_event_s *events,
+				unsigned int count);
+
 int _minictrl_viewer_req_message_send(void);
 
+/* decodes the arguments of a provider signal, sequence and timestamp
+ * are left 0 and strings point into msg */
+int _minictrl_event_decode(DBusMessage *msg, minicontrol_action_e action,
+				minicontrol_event_s *event);
+
+/* decodes up to max records of a batch signal, broken records are skipped */
+int _minictrl_event_batch_decode(DBusMessage *msg,
+				minicontrol_event_s *events,
+				unsigned int max, unsigned int *count);
+
+const char *_minictrl_event_sig_name(minicontrol_action_e action);
+
+/* opens the bus connection signal handles share ahead of attaching them */
+int _minictrl_dbus_connect(void);
+
+void _minictrl_dbus_disconnect(void);
+
 minictrl_sig_handle *_minictrl_dbus_sig_handle_attach(const char *signal,
 				void (*callback) (void *data, DBusMessage *msg),
 				void *data);
 
 void _minictrl_dbus_sig_handle_dettach(minictrl_sig_handle *handle);
 
+minictrl_name_watch *_minictrl_dbus_name_watch_attach(
+				void (*callback) (void *data, const char *name),
+				void *data);
+
+int _minictrl_dbus_name_watch_add(minictrl_name_watch *watch,
+				const char *name);
+
+void _minictrl_dbus_name_watch_remove(minictrl_name_watch *watch,
+				const char *name);
+
+void _minictrl_dbus_name_watch_dettach(minictrl_name_watch *watch);
+
+int _minictrl_state_publish(const char *name, int state,
+				unsigned int width, unsigned int height,
+				minicontrol_priority_e priority);
+
+void _minictrl_state_remove(const char *name);
+
+/* returns 1 if the caller is the one to send STOP for a provider whose
+ * window is gone, 0 if the provider or another viewer did already */
+int _minictrl_state_stop_claim(const char *name);
+
+int _minictrl_state_read(minicontrol_state_entry_s *entries,
+				unsigned int max, unsigned int *count);
+
+/* opens and locks the journal, entries it holds for bus_id are returned
+ * and have to be freed, a journal of another bus is discarded */
+int _minictrl_journal_open(const char *bus_id,
+			minictrl_journal_entry **entries,
+			unsigned int *count);
+
+void _minictrl_journal_close(void);
+
+void _minictrl_journal_remove(void);
+
+int _minictrl_journal_set(const minictrl_journal_entry *entry);
+
+int _minictrl_journal_del(const char *name);
+
+unsigned int _minictrl_journal_record_count(void);
+
+int _minictrl_journal_rewrite(const char *bus_id,
+			const minictrl_journal_entry *entries,
+			unsigned int count);
+
+/* blocking calls to the bus daemon */
+int _minictrl_dbus_bus_id_get(char *id, int size);
+
+int _minictrl_dbus_names_alive(const char **names, unsigned int count,
+				int *alive);
+
+/* private directory of the user for files shared between minicontrol
+ * processes, $XDG_RUNTIME_DIR/minicontrol */
+int _minictrl_runtime_dir_get(char *path, int size);
+
+/* opens a regular file of this user in the runtime directory, never
+ * through a symbolic link */
+int _minictrl_runtime_open(const char *file, int flags, mode_t mode);
+
+void _minictrl_resource_add(int type, long bytes);
+
+void _minictrl_resource_del(int type, long bytes);
+
+void _minictrl_resource_get(minicontrol_resource_s *res);
+
+void _minictrl_resource_dump(const char *owner);
+
 #endif /* _MINICTRL_INTERNAL_H_ */
 
@@ -55,6 +55,65 @@ typedef void (*minicontrol_monitor_cb) (minicontrol_action_e action,
 					minicontrol_priority_e priority,
 					void *data);
 
+/**
+ * @brief Called when event is triggered
+ * @param[in] event The fired event
+ * @param[in] data user data
+ * @pre minicontrol_monitor_event_start() used to register this callback
+ * @see #minicontrol_event_s
+ */
+typedef void (*minicontrol_monitor_event_cb) (const minicontrol_event_s *event,
+					void *data);
+
+/**
+ * @brief Called with the events delivered in one main loop iteration
+ * @param[in] events The fired events, oldest first
+ * @param[in] count The number of events
+ * @param[in] data user data
+ * @pre minicontrol_monitor_batch_start() used to register this callback
+ * @see #minicontrol_event_s
+ */
+typedef void (*minicontrol_monitor_batch_cb) (const minicontrol_event_s *events,
+					unsigned int count, void *data);
+
+/**
+ * @brief Statistics of the monitor event queue
+ */
+typedef struct _minicontrol_monitor_queue_stats {
+	unsigned long received; /**< events received from providers */
+	unsigned long delivered; /**< events delivered to the callback */
+	unsigned long coalesced; /**< events merged into a pending event */
+	unsigned long overflow; /**< times the queue was full and flushed early */
+	unsigned int high_water; /**< maximum number of pending events */
+	unsigned long stop_suppressed; /**< STOP of providers not running, e.g. sent again by another viewer */
+	unsigned long throttled; /**< updates held back from providers exceeding the rate limit */
+	unsigned long unknown_dropped; /**< RESIZE and PRIORITY of providers not running, e.g. whose START was missed */
+} minicontrol_monitor_queue_stats_s;
+
+/**
+ * @brief Provider which exceeded the monitor rate limit
+ */
+typedef struct _minicontrol_monitor_throttle {
+	char name[MINICONTROL_STATE_NAME_MAX]; /**< name of provider */
+	int throttled; /**< 1 if updates of the provider are held back right now */
+	unsigned long held; /**< updates collapsed into a later update */
+	unsigned int count; /**< times the provider exceeded the rate limit */
+} minicontrol_monitor_throttle_s;
+
+/**
+ * @brief Time spent in the steps of minicontrol_monitor_start()
+ */
+typedef struct _minicontrol_monitor_startup {
+	unsigned long long connect_usec; /**< connecting to the bus */
+	unsigned long long match_usec; /**< subscribing to provider signals */
+	unsigned long long watch_usec; /**< setting up the provider liveness watch */
+	unsigned long long journal_usec; /**< restoring providers from the journal */
+	unsigned long long request_usec; /**< asking running providers to report */
+	unsigned long long total_usec; /**< whole call */
+	unsigned int journal_restored; /**< providers restored from the journal */
+	unsigned int journal_dropped; /**< journal entries found stale, now or after the grace time */
+} minicontrol_monitor_startup_s;
+
 /**
  * @addtogroup MINICONTROL_MONITOR_LIBRARY
  * @{
@@ -62,12 +121,43 @@ typedef void (*minicontrol_monitor_cb) (minicontrol_action_e action,
 
 /**
  * @brief Register a callback for events originated by minicontrol provider
+ * @details #MINICONTROL_ACTION_PRIORITY is not passed to this callback,
+ * RESIZE carries the priority as before
  * @param[in] callback callback function
  * @param[in] data user data
  */
 minicontrol_error_e minicontrol_monitor_start(minicontrol_monitor_cb callback,
 					void *data);
 
+/**
+ * @brief Register a callback taking decoded events originated by minicontrol provider
+ * @details Replaces a callback registered by minicontrol_monitor_start() or
+ * minicontrol_monitor_batch_start().
+ * @param[in] callback callback function
+ * @param[in] data user data
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_monitor_event_cb
+ */
+minicontrol_error_e minicontrol_monitor_event_start(
+				minicontrol_monitor_event_cb callback,
+				void *data);
+
+/**
+ * @brief Register a callback taking all events delivered at once
+ * @details The pending events of the queue are passed in a single call.
+ * With queue size 0 every event is passed on its own.
+ * Replaces a callback registered by minicontrol_monitor_start() or
+ * minicontrol_monitor_event_start().
+ * @param[in] callback callback function
+ * @param[in] data user data
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_monitor_batch_cb
+ * @see minicontrol_monitor_queue_size_set()
+ */
+minicontrol_error_e minicontrol_monitor_batch_start(
+				minicontrol_monitor_batch_cb callback,
+				void *data);
+
 /**
  * @brief Unregister a callback for events originated by minicontrol provider
  * @return #MINICONTROL_ERROR_NONE if success, other value if failure
@@ -75,5 +165,113 @@ minicontrol_error_e minicontrol_monitor_start(minicontrol_monitor_cb callback,
  */
 minicontrol_error_e minicontrol_monitor_stop(void);
 
+/**
+ * @brief Set the number of providers whose events can be pending at once
+ * @details Events are queued and delivered once per main loop iteration.
+ * Pending events of the same provider are merged, e.g. START followed by
+ * RESIZE is delivered as a START with the final size and START followed
+ * by STOP is not delivered at all. When the queue is full it is flushed
+ * immediately. Size 0 delivers every event synchronously. Default is 64.
+ * @param[in] size maximum number of pending events
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ */
+minicontrol_error_e minicontrol_monitor_queue_size_set(unsigned int size);
+
+/**
+ * @brief Get statistics of the monitor event queue
+ * @param[out] stats queue statistics
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ */
+minicontrol_error_e minicontrol_monitor_queue_stats_get(
+				minicontrol_monitor_queue_stats_s *stats);
+
+/**
+ * @brief Limit the rate of updates delivered per provider
+ * @details Every provider may deliver burst RESIZE and PRIORITY events at
+ * once and rate events per second after that. Updates of a provider
+ * exceeding this are held back and delivered as a single event with the
+ * latest state once the provider is within its rate again. START and
+ * STOP are never held back. Updates of a provider whose START was not
+ * received are dropped. Rate 0 disables the limit. Default is 30
+ * events per second with a burst of 60.
+ * @param[in] rate events per second per provider
+ * @param[in] burst events a provider may send at once
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ */
+minicontrol_error_e minicontrol_monitor_rate_limit_set(unsigned int rate,
+					unsigned int burst);
+
+/**
+ * @brief Get the running providers which exceeded the rate limit
+ * @param[out] entries array filled with providers
+ * @param[in] max number of elements of entries
+ * @param[out] count number of entries filled
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_monitor_throttle_s
+ * @see minicontrol_monitor_rate_limit_set()
+ */
+minicontrol_error_e minicontrol_monitor_throttle_get(
+				minicontrol_monitor_throttle_s *entries,
+				unsigned int max, unsigned int *count);
+
+/**
+ * @brief Enable or disable the monitor state journal
+ * @details The journal keeps the running providers in a file of the private
+ * runtime directory of the user.
+ * When the monitor starts again, e.g. after its process restarted, the
+ * providers of the journal still connected to the bus are reported with
+ * #MINICONTROL_ACTION_START right away. Their answers to the request for
+ * running providers are only reported if they differ. Restored providers
+ * not answering within a second are reported with
+ * #MINICONTROL_ACTION_STOP. Only one monitor at a time can keep the
+ * journal. Disabling it removes the journal. Disabled by default.
+ * @param[in] enable non-zero to enable the journal
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ */
+minicontrol_error_e minicontrol_monitor_journal_set(int enable);
+
+/**
+ * @brief Get the time spent starting the monitor
+ * @details Filled by the call of minicontrol_monitor_start(),
+ * minicontrol_monitor_event_start() or minicontrol_monitor_batch_start()
+ * that started the monitor. All zero before.
+ * @param[out] startup time of each step in microseconds
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_monitor_startup_s
+ */
+minicontrol_error_e minicontrol_monitor_startup_get(
+				minicontrol_monitor_startup_s *startup);
+
+/**
+ * @brief Read the providers currently known from the shared state table
+ * @details Providers publish their state, size and priority to a memory
+ * mapped table on start, stop, resize and priority change. This reads it
+ * without any IPC and does not need minicontrol_monitor_start().
+ * The table is private to the user, only providers of the same user
+ * are seen. Entries of dead processes are skipped.
+ * @param[out] entries array filled with providers
+ * @param[in] max number of elements of entries
+ * @param[out] count number of entries filled
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_state_entry_s
+ */
+minicontrol_error_e minicontrol_monitor_state_get(
+				minicontrol_state_entry_s *entries,
+				unsigned int max, unsigned int *count);
+
+/**
+ * @brief Get resources currently held by the minicontrol monitor library
+ * @param[out] res resource counters
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_resource_s
+ */
+minicontrol_error_e minicontrol_monitor_resource_get(
+					minicontrol_resource_s *res);
+
+/**
+ * @brief Log resources and signal handles held by the minicontrol monitor library
+ */
+void minicontrol_monitor_resource_dump(void);
+
 #endif /* _MINICTRL_MONITOR_H_ */
 
@@ -18,12 +18,38 @@
 #define _MINICTRL_PROVIDER_H_
 
 #include <Evas.h>
+#include <minicontrol-error.h>
+#include <minicontrol-type.h>
 
 /**
  * @defgroup MINICONTROL_PROVIDER_LIBRARY minicontrol provider library
  * @brief This minicontrol provider library used to create evas socket window
  */
 
+/**
+ * @brief Structure describing a socket window to create
+ */
+typedef struct _minicontrol_win_info {
+	const char *name; /**< name of socket window, mandatory */
+	minicontrol_priority_e priority; /**< 0 derives it from the name suffix, other values not in #minicontrol_priority_e fail */
+	const char *category; /**< category reported to monitors, may be NULL */
+	int width; /**< preferred width, 0 keeps the default */
+	int height; /**< preferred height, 0 keeps the default */
+	minicontrol_update_policy_e update_policy; /**< see minicontrol_win_update_policy_set() */
+	unsigned int update_interval; /**< interval of the update policy in milliseconds */
+	unsigned int max_fps; /**< see minicontrol_win_frame_limit_set(), 0 is not capped */
+	unsigned int pixel_budget; /**< see minicontrol_win_frame_limit_set(), 0 is unlimited */
+} minicontrol_win_info_s;
+
+/**
+ * @brief Statistics of frames of a socket window
+ */
+typedef struct _minicontrol_win_frame_stats {
+	unsigned long rendered; /**< frames sent to viewers */
+	unsigned long throttled; /**< animator ticks skipped by the frame rate cap while animating */
+	unsigned long over_budget; /**< animator ticks skipped by the pixel budget while animating */
+} minicontrol_win_frame_stats_s;
+
 /**
  * @addtogroup MINICONTROL_PROVIDER_LIBRARY
  * @{
@@ -36,5 +62,108 @@
  */
 Evas_Object *minicontrol_win_add(const char *name);
 
+/**
+ * @brief This function create evas socket window described by info
+ * @param[in] info description of socket window
+ * @return evas object of socket window, NULL if info is invalid
+ * @see #minicontrol_win_info_s
+ */
+Evas_Object *minicontrol_win_add_with_info(const minicontrol_win_info_s *info);
+
+/**
+ * @brief Change the priority of a socket window
+ * @details Monitors receive #MINICONTROL_ACTION_PRIORITY if the window is running
+ * @param[in] minicontrol evas object of socket window
+ * @param[in] priority new priority
+ * @return #MINICONTROL_ERROR_NONE if success,
+ * #MINICONTROL_ERROR_INVALID_PARAMETER if priority is not one of #minicontrol_priority_e
+ */
+minicontrol_error_e minicontrol_win_priority_set(Evas_Object *minicontrol,
+				minicontrol_priority_e priority);
+
+/**
+ * @brief Set how size changes of a socket window are reported to monitors
+ * @param[in] minicontrol evas object of socket window
+ * @param[in] policy update policy
+ * @param[in] interval_ms interval for #MINICONTROL_UPDATE_POLICY_DEBOUNCE
+ * and #MINICONTROL_UPDATE_POLICY_FINAL in milliseconds, ignored otherwise
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_update_policy_e
+ */
+minicontrol_error_e minicontrol_win_update_policy_set(Evas_Object *minicontrol,
+				minicontrol_update_policy_e policy,
+				unsigned int interval_ms);
+
+/**
+ * @brief Get the number of size changes reported and held back by the update policy
+ * @param[in] minicontrol evas object of socket window
+ * @param[out] emitted number of RESIZE events sent
+ * @param[out] suppressed number of size changes merged into a later event
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ */
+minicontrol_error_e minicontrol_win_update_stats_get(Evas_Object *minicontrol,
+				unsigned int *emitted,
+				unsigned int *suppressed);
+
+/**
+ * @brief Limit how often a socket window sends frames to viewers
+ * @details Once limited, the first change of an idle window is rendered
+ * as usual. Following changes are rendered at most on each animator tick,
+ * so a cap is rounded to ticks, until a tick has nothing to draw.
+ * Changes made in between are merged into the next frame. Each frame
+ * is charged its whole window area against the pixel budget, which
+ * allows a burst of up to one second of budget.
+ * @param[in] minicontrol evas object of socket window
+ * @param[in] max_fps maximum frames per second, 0 is not capped
+ * @param[in] pixel_budget maximum pixels per second, 0 is unlimited
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see minicontrol_win_frame_stats_get()
+ */
+minicontrol_error_e minicontrol_win_frame_limit_set(Evas_Object *minicontrol,
+				unsigned int max_fps,
+				unsigned int pixel_budget);
+
+/**
+ * @brief Get frame statistics of a socket window
+ * @param[in] minicontrol evas object of socket window
+ * @param[out] stats frame statistics
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ */
+minicontrol_error_e minicontrol_win_frame_stats_get(Evas_Object *minicontrol,
+				minicontrol_win_frame_stats_s *stats);
+
+/**
+ * @brief Begin a transaction grouping changes of socket windows
+ * @details Until the matching minicontrol_win_transaction_commit(), starts,
+ * stops, resizes and priority changes of all socket windows of this process
+ * are held back. On commit they are sent as one message, which monitors
+ * deliver in one batch, e.g. one window stopping and another starting in
+ * its place. Transactions may be nested, changes are sent on the outermost
+ * commit. A transaction of more than 32 changes is split.
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see minicontrol_win_transaction_commit()
+ */
+minicontrol_error_e minicontrol_win_transaction_begin(void);
+
+/**
+ * @brief Commit a transaction begun by minicontrol_win_transaction_begin()
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ */
+minicontrol_error_e minicontrol_win_transaction_commit(void);
+
+/**
+ * @brief Get resources currently held by the minicontrol provider library
+ * @param[out] res resource counters
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_resource_s
+ */
+minicontrol_error_e minicontrol_provider_resource_get(
+					minicontrol_resource_s *res);
+
+/**
+ * @brief Log resources and signal handles held by the minicontrol provider library
+ */
+void minicontrol_provider_resource_dump(void);
+
 #endif /* _MINICTRL_PROVIDER_H_ */
 
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _MINICTRL_TRACE_H_
+#define _MINICTRL_TRACE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <dbus/dbus.h>
+
+/*
+ * Binary event trace, enabled by setting MINICONTROL_TRACE to a file path.
+ * The file starts with MINICTRL_TRACE_MAGIC and MINICTRL_TRACE_VERSION
+ * (4 bytes each), followed by records of struct _minictrl_trace_record
+ * each immediately followed by name_len bytes of name (no '\0').
+ */
+#define MINICTRL_TRACE_ENV "MINICONTROL_TRACE"
+#define MINICTRL_TRACE_MAGIC 0x5254434d /* "MCTR" */
+#define MINICTRL_TRACE_VERSION 1
+
+enum {
+	MINICTRL_TRACE_DIR_RECV = 0,
+	MINICTRL_TRACE_DIR_SEND,
+};
+
+enum {
+	MINICTRL_TRACE_SIG_UNKNOWN = 0,
+	MINICTRL_TRACE_SIG_START,
+	MINICTRL_TRACE_SIG_STOP,
+	MINICTRL_TRACE_SIG_RESIZE,
+	MINICTRL_TRACE_SIG_RUNNING_REQ,
+	MINICTRL_TRACE_SIG_PRIORITY,
+};
+
+struct _minictrl_trace_record {
+	uint64_t timestamp; /* CLOCK_MONOTONIC in usec */
+	uint8_t dir;
+	uint8_t signal;
+	uint16_t name_len;
+	uint32_t width;
+	uint32_t height;
+	uint32_t priority;
+} __attribute__ ((packed));
+
+int _minictrl_trace_enabled(void);
+
+void _minictrl_trace_write(int dir, const char *sig_name,
+				const char *name, unsigned int width,
+				unsigned int height, unsigned int priority);
+
+void _minictrl_trace_message(int dir, DBusMessage *msg);
+
+const char *_minictrl_trace_sig_name(int signal);
+
+int _minictrl_trace_read_header(FILE *fp);
+
+int _minictrl_trace_read(FILE *fp, struct _minictrl_trace_record *rec,
+				char *name, unsigned int name_size);
+
+#endif /* _MINICTRL_TRACE_H_ */
+
@@ -34,6 +34,7 @@ typedef enum _minicontrol_action {
 	MINICONTROL_ACTION_START = 0,
 	MINICONTROL_ACTION_STOP,
 	MINICONTROL_ACTION_RESIZE,
+	MINICONTROL_ACTION_PRIORITY, /**< priority of a running provider is changed, not passed to #minicontrol_monitor_cb */
 } minicontrol_action_e;
 
 /**
@@ -45,4 +46,61 @@ typedef enum {
 	MINICONTROL_PRIORITY_LOW = 1,
 }minicontrol_priority_e;
 
+/**
+ * @breief Enumeration describing when a provider reports size changes
+ */
+typedef enum {
+	MINICONTROL_UPDATE_POLICY_IMMEDIATE = 0, /**< report every size change */
+	MINICONTROL_UPDATE_POLICY_PER_FRAME, /**< at most once per animator frame */
+	MINICONTROL_UPDATE_POLICY_DEBOUNCE, /**< at most once per interval, with the latest size */
+	MINICONTROL_UPDATE_POLICY_FINAL, /**< only once the size is stable for an interval */
+} minicontrol_update_policy_e;
+
+/**
+ * @breief Maximum length of a provider name in the shared state table, including '\0'
+ */
+#define MINICONTROL_STATE_NAME_MAX 128
+
+/**
+ * @breief Structure describing a provider in the shared state table
+ */
+typedef struct _minicontrol_state_entry {
+	char name[MINICONTROL_STATE_NAME_MAX]; /**< name of provider */
+	int running; /**< 1 if the provider is running */
+	int pid; /**< process id of the provider */
+	unsigned int width; /**< width of provider */
+	unsigned int height; /**< height of provider */
+	minicontrol_priority_e priority; /**< priority of provider */
+	unsigned long long updated_usec; /**< CLOCK_MONOTONIC time of the last update */
+} minicontrol_state_entry_s;
+
+/**
+ * @breief Structure describing resources currently held by a minicontrol library
+ */
+typedef struct _minicontrol_resource {
+	unsigned int provider_count; /**< provider windows */
+	unsigned int handle_count; /**< signal handles */
+	unsigned int connection_count; /**< bus connections */
+	unsigned int match_count; /**< match rules added to the bus */
+	unsigned int plug_name_count; /**< names held by viewers */
+	unsigned int fd_count; /**< file descriptors */
+	unsigned long bytes; /**< heap used by the above */
+} minicontrol_resource_s;
+
+/**
+ * @breief Event originated by minicontrol provider
+ * @details Strings are only valid during the callback invocation.
+ */
+typedef struct _minicontrol_event {
+	minicontrol_action_e action; /**< type of fired event */
+	const char *name; /**< name of provider */
+	unsigned int name_len; /**< length of name without the terminating null */
+	const char *category; /**< category of provider on START, otherwise NULL */
+	unsigned int width; /**< width of provider */
+	unsigned int height; /**< height of provider */
+	minicontrol_priority_e priority; /**< priority of provider */
+	unsigned int sequence; /**< increases with every event received by the monitor */
+	unsigned long long timestamp; /**< monotonic time the event was received, in microseconds */
+} minicontrol_event_s;
+
 #endif /* _MINICTRL_TYPE_H_ */
@@ -18,6 +18,8 @@
 #define _MINICTRL_VIEWER_H_
 
 #include <Evas.h>
+#include <minicontrol-error.h>
+#include <minicontrol-type.h>
 
 /**
  * @defgroup MINICONTROL_VIEWER_LIBRARY minicontrol provider library
@@ -44,5 +46,68 @@ Evas_Object *minicontrol_viewer_add(Evas_Object *parent, const char *svr_name);
  */
 Evas_Object *minicontrol_viewer_image_object_get(const Evas_Object *obj);
 
+/**
+ * @brief Enable or disable the shared thumbnail cache
+ * @details When enabled, the last frame of a minicontrol is stored in a
+ * small memory mapped cache file when its viewer is deleted, and
+ * minicontrol_viewer_add() shows it as a placeholder until the first live
+ * frame arrives. The entry is removed when the provider goes away.
+ * The cache lives in the private runtime directory of the user, so it is
+ * only shared between viewers of the same user, and keeps the 32 most
+ * recently stored frames. Disabled by default.
+ * @param[in] enable EINA_TRUE to enable the cache
+ */
+void minicontrol_viewer_thumbnail_cache_set(Eina_Bool enable);
+
+/**
+ * @brief Suspend or resume a minicontrol viewer
+ * @details A suspended viewer is not drawn, so frames of the provider are
+ * no longer rendered or uploaded by the viewer. The provider keeps
+ * running and is not notified. On resume the latest frame is shown.
+ * @param[in] obj minicontrol object returned by minicontrol_viewer_add()
+ * @param[in] suspend EINA_TRUE to suspend, EINA_FALSE to resume
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ */
+minicontrol_error_e minicontrol_viewer_suspend_set(Evas_Object *obj,
+					Eina_Bool suspend);
+
+/**
+ * @brief Get whether a minicontrol viewer is suspended
+ * @details A viewer is suspended by minicontrol_viewer_suspend_set() or,
+ * with automatic suspension, while it is out of view.
+ * @param[in] obj minicontrol object returned by minicontrol_viewer_add()
+ * @return EINA_TRUE if the viewer is suspended
+ */
+Eina_Bool minicontrol_viewer_suspended_get(const Evas_Object *obj);
+
+/**
+ * @brief Enable or disable automatic suspension of viewers out of view
+ * @details When enabled, a viewer moved or resized entirely outside of
+ * its clippers or the canvas viewport, e.g. scrolled out of a list, is
+ * suspended until it is moved back into view. Moving, resizing, showing
+ * and hiding its clippers is followed as well. Changes of the canvas
+ * viewport or of the visibility of the window holding the viewer are
+ * not, they are taken into account with the next change of the viewer
+ * or its clippers. Enabling or disabling it applies to existing viewers
+ * right away. Disabled by default.
+ * @param[in] enable EINA_TRUE to enable automatic suspension
+ * @see minicontrol_viewer_suspend_set()
+ */
+void minicontrol_viewer_auto_suspend_set(Eina_Bool enable);
+
+/**
+ * @brief Get resources currently held by the minicontrol viewer library
+ * @param[out] res resource counters
+ * @return #MINICONTROL_ERROR_NONE if success, other value if failure
+ * @see #minicontrol_resource_s
+ */
+minicontrol_error_e minicontrol_viewer_resource_get(
+					minicontrol_resource_s *res);
+
+/**
+ * @brief Log resources held by the minicontrol viewer library
+ */
+void minicontrol_viewer_resource_dump(void);
+
 #endif /* _MINICTRL_VIEWER_H_ */
 
@@ -10,6 +10,7 @@ BuildRequires: pkgconfig(dbus-glib-1)
 BuildRequires: pkgconfig(elementary)
 BuildRequires: pkgconfig(evas)
 BuildRequires: pkgconfig(ecore-evas)
+BuildRequires: pkgconfig(ecore)
 BuildRequires: pkgconfig(dlog)
 BuildRequires: cmake
 Requires(post): /sbin/ldconfig
@@ -15,141 +15,1540 @@
  */
 
 #include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <pthread.h>
 #include <dbus/dbus.h>
 #include <dbus/dbus-glib-lowlevel.h>
+#include <Ecore.h>
 
 #include "minicontrol-error.h"
 #include "minicontrol-type.h"
 #include "minicontrol-internal.h"
+#include "minicontrol-trace.h"
 #include "minicontrol-log.h"
 
 #define MINICTRL_DBUS_PATH "/org/tizen/minicontrol"
 #define MINICTRL_DBUS_INTERFACE "org.tizen.minicontrol.signal"
+#define MINICTRL_IO_THREAD_ENV "MINICONTROL_IO_THREAD"
+#define MINICTRL_BUS_ENV "MINICONTROL_BUS"
+#define MINICTRL_MAINLOOP_ENV "MINICONTROL_MAINLOOP"
+#define MINICTRL_RUNTIME_DIR "minicontrol"
 
 struct _minictrl_sig_handle {
 	DBusConnection *conn;
 	void (*callback) (void *data, DBusMessage *msg);
 	void *user_data;
-	char *signal;
+	const char *signal; /* interned */
+	int ref;
+	int detached;
+	struct timespec created;
+	struct _minictrl_sig_handle *next;
+	struct _minictrl_sig_handle *all_next;
 };
 
+/* node of the lock-free multi producer, single consumer queue */
+struct _minictrl_io_node {
+	struct _minictrl_io_node *next;
+	minictrl_sig_handle *handle;
+	DBusMessage *msg;
+};
+
+struct _minictrl_io_queue {
+	struct _minictrl_io_node *head;
+	struct _minictrl_io_node *tail;
+	struct _minictrl_io_node stub;
+};
+
+/*
+ * In I/O thread mode all bus traffic of the process goes through one
+ * private connection owned by a worker thread. Received signals are
+ * passed to the main loop via the inbox queue and an Ecore pipe,
+ * outgoing messages are passed to the worker via the outbox queue.
+ */
+struct _minictrl_io_worker {
+	pthread_t thread;
+	DBusConnection *conn;
+	int dead; /* set by the worker when the connection is closed */
+	int joined;
+	int wake_fd[2];
+	Ecore_Pipe *pipe;
+	int pipe_pending;
+	struct _minictrl_io_queue inbox;
+	struct _minictrl_io_queue outbox;
+	pthread_mutex_t lock; /* protects handles */
+	minictrl_sig_handle *handles;
+};
+
+static struct _minictrl_io_worker *g_io_worker;
+
+/* resources held by this library, only touched on the main thread */
+static minicontrol_resource_s g_resource;
+static minictrl_sig_handle *g_handles;
+static Eina_Mempool *g_handle_pool;
+static DBusConnection *g_sig_conn;
+static int g_sig_conn_users;
+
+void _minictrl_resource_add(int type, long bytes)
+{
+	switch (type) {
+	case MINICTRL_RESOURCE_PROVIDER:
+		g_resource.provider_count++;
+		break;
+	case MINICTRL_RESOURCE_HANDLE:
+		g_resource.handle_count++;
+		break;
+	case MINICTRL_RESOURCE_CONNECTION:
+		g_resource.connection_count++;
+		break;
+	case MINICTRL_RESOURCE_MATCH:
+		g_resource.match_count++;
+		break;
+	case MINICTRL_RESOURCE_PLUG_NAME:
+		g_resource.plug_name_count++;
+		break;
+	case MINICTRL_RESOURCE_FD:
+		g_resource.fd_count++;
+		break;
+	default:
+		return;
+	}
+
+	g_resource.bytes += bytes;
+}
+
+void _minictrl_resource_del(int type, long bytes)
+{
+	switch (type) {
+	case MINICTRL_RESOURCE_PROVIDER:
+		g_resource.provider_count--;
+		break;
+	case MINICTRL_RESOURCE_HANDLE:
+		g_resource.handle_count--;
+		break;
+	case MINICTRL_RESOURCE_CONNECTION:
+		g_resource.connection_count--;
+		break;
+	case MINICTRL_RESOURCE_MATCH:
+		g_resource.match_count--;
+		break;
+	case MINICTRL_RESOURCE_PLUG_NAME:
+		g_resource.plug_name_count--;
+		break;
+	case MINICTRL_RESOURCE_FD:
+		g_resource.fd_count--;
+		break;
+	default:
+		return;
+	}
+
+	g_resource.bytes -= bytes;
+}
+
+void _minictrl_resource_get(minicontrol_resource_s *res)
+{
+	if (res)
+		*res = g_resource;
+}
+
+void _minictrl_resource_dump(const char *owner)
+{
+	minictrl_sig_handle *handle;
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	INFO("[%s] provider[%u] handle[%u] connection[%u] match[%u] "
+		"plug name[%u] fd[%u] bytes[%lu]", owner,
+		g_resource.provider_count, g_resource.handle_count,
+		g_resource.connection_count, g_resource.match_count,
+		g_resource.plug_name_count, g_resource.fd_count,
+		g_resource.bytes);
+
+	for (handle = g_handles; handle; handle = handle->all_next)
+		INFO("[%s] handle[%p] signal[%s] detached[%d] age[%ld s]",
+			owner, handle, handle->signal, handle->detached,
+			(long)(now.tv_sec - handle->created.tv_sec));
+}
+
+/* the signal name is shared by all handles of the process */
+static long __sig_handle_size(minictrl_sig_handle *handle)
+{
+	return sizeof(minictrl_sig_handle);
+}
+
+/* handles come and go with every window, keep them in one pool */
+static minictrl_sig_handle *__sig_handle_new(const char *signal)
+{
+	minictrl_sig_handle *handle;
+
+	if (!g_handle_pool) {
+		eina_init();
+		g_handle_pool = eina_mempool_add("chained_mempool",
+				"minicontrol_sig_handle", NULL,
+				sizeof(minictrl_sig_handle), 16);
+		if (!g_handle_pool)
+			g_handle_pool = eina_mempool_add("pass_through",
+					"minicontrol_sig_handle", NULL);
+		if (!g_handle_pool)
+			return NULL;
+	}
+
+	handle = eina_mempool_malloc(g_handle_pool,
+				sizeof(minictrl_sig_handle));
+	if (!handle)
+		return NULL;
+
+	memset(handle, 0, sizeof(minictrl_sig_handle));
+	handle->signal = eina_stringshare_add(signal);
+	if (!handle->signal) {
+		eina_mempool_free(g_handle_pool, handle);
+		return NULL;
+	}
+
+	return handle;
+}
+
+static void __sig_handle_free(minictrl_sig_handle *handle)
+{
+	eina_stringshare_del(handle->signal);
+	eina_mempool_free(g_handle_pool, handle);
+}
+
+static void __io_queue_init(struct _minictrl_io_queue *q)
+{
+	q->stub.next = NULL;
+	q->head = &q->stub;
+	q->tail = &q->stub;
+}
+
+static void __io_queue_push(struct _minictrl_io_queue *q,
+				struct _minictrl_io_node *node)
+{
+	struct _minictrl_io_node *prev;
+
+	node->next = NULL;
+	prev = __atomic_exchange_n(&q->head, node, __ATOMIC_ACQ_REL);
+	__atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+}
+
+/* must be called from the single consumer only */
+static struct _minictrl_io_node *__io_queue_pop(struct _minictrl_io_queue *q)
+{
+	struct _minictrl_io_node *tail = q->tail;
+	struct _minictrl_io_node *next;
+
+	next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	if (tail == &q->stub) {
+		if (!next)
+			return NULL;
+		q->tail = next;
+		tail = next;
+		next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	}
+
+	if (next) {
+		q->tail = next;
+		return tail;
+	}
+
+	/* a producer is between exchange and store, retry later */
+	if (tail != __atomic_load_n(&q->head, __ATOMIC_ACQUIRE))
+		return NULL;
+
+	__io_queue_push(q, &q->stub);
+
+	next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	if (next) {
+		q->tail = next;
+		return tail;
+	}
+
+	return NULL;
+}
+
+static void __sig_handle_register(minictrl_sig_handle *handle)
+{
+	clock_gettime(CLOCK_MONOTONIC, &handle->created);
+
+	handle->all_next = g_handles;
+	g_handles = handle;
+
+	_minictrl_resource_add(MINICTRL_RESOURCE_HANDLE,
+				__sig_handle_size(handle));
+}
+
+static void __sig_handle_ref(minictrl_sig_handle *handle)
+{
+	__atomic_add_fetch(&handle->ref, 1, __ATOMIC_RELAXED);
+}
+
+static void __sig_handle_unref(minictrl_sig_handle *handle)
+{
+	minictrl_sig_handle **prev;
+
+	if (__atomic_sub_fetch(&handle->ref, 1, __ATOMIC_ACQ_REL))
+		return;
+
+	for (prev = &g_handles; *prev; prev = &(*prev)->all_next) {
+		if (*prev == handle) {
+			*prev = handle->all_next;
+			break;
+		}
+	}
+
+	_minictrl_resource_del(MINICTRL_RESOURCE_HANDLE,
+				__sig_handle_size(handle));
+
+	__sig_handle_free(handle);
+}
+
+static void __io_worker_wakeup(struct _minictrl_io_worker *worker)
+{
+	char c = 0;
+
+	if (write(worker->wake_fd[1], &c, 1) < 0)
+		DBG("wake pipe is full");
+}
+
+static int __io_worker_alive(struct _minictrl_io_worker *worker)
+{
+	return !__atomic_load_n(&worker->dead, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Joins a dead worker, the main thread is the only consumer of the
+ * outbox afterwards and frees messages nobody will send anymore.
+ * The connection is kept, handles attached to it still refer to it.
+ */
+static void __io_worker_reap(struct _minictrl_io_worker *worker)
+{
+	struct _minictrl_io_node *node;
+
+	if (worker->joined)
+		return;
+
+	pthread_join(worker->thread, NULL);
+	worker->joined = 1;
+
+	while ((node = __io_queue_pop(&worker->outbox))) {
+		dbus_message_unref(node->msg);
+		free(node);
+	}
+
+	INFO("minicontrol I/O thread is stopped");
+}
+
+static void __io_pipe_cb(void *data, void *buffer, unsigned int nbyte)
+{
+	struct _minictrl_io_worker *worker = data;
+	struct _minictrl_io_node *node;
+
+	__atomic_store_n(&worker->pipe_pending, 0, __ATOMIC_RELEASE);
+
+	while ((node = __io_queue_pop(&worker->inbox))) {
+		minictrl_sig_handle *handle = node->handle;
+
+		if (!handle->detached && handle->callback) {
+			_minictrl_trace_message(MINICTRL_TRACE_DIR_RECV,
+						node->msg);
+			handle->callback(handle->user_data, node->msg);
+		}
+
+		dbus_message_unref(node->msg);
+		__sig_handle_unref(handle);
+		free(node);
+	}
+
+	if (!__io_worker_alive(worker))
+		__io_worker_reap(worker);
+}
+
+/* runs on the worker thread */
+static DBusHandlerResult __io_worker_filter(DBusConnection *conn,
+		DBusMessage *msg, void *user_data)
+{
+	struct _minictrl_io_worker *worker = user_data;
+	minictrl_sig_handle *handle;
+	struct _minictrl_io_node *node;
+	const char *interface;
+	int queued = 0;
+
+	interface = dbus_message_get_interface(msg);
+	if (!interface)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	if (strcmp(MINICTRL_DBUS_INTERFACE, interface))
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	pthread_mutex_lock(&worker->lock);
+	for (handle = worker->handles; handle; handle = handle->next) {
+		if (!dbus_message_is_signal(msg, interface, handle->signal))
+			continue;
+
+		node = malloc(sizeof(struct _minictrl_io_node));
+		if (!node) {
+			ERR("fail to alloc io node");
+			break;
+		}
+
+		__sig_handle_ref(handle);
+		node->handle = handle;
+		node->msg = dbus_message_ref(msg);
+		__io_queue_push(&worker->inbox, node);
+		queued = 1;
+	}
+	pthread_mutex_unlock(&worker->lock);
+
+	if (!queued)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	if (!__atomic_exchange_n(&worker->pipe_pending, 1, __ATOMIC_ACQ_REL))
+		ecore_pipe_write(worker->pipe, "", 1);
+
+	return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static void *__io_worker_main(void *data)
+{
+	struct _minictrl_io_worker *worker = data;
+	struct _minictrl_io_node *node;
+	struct pollfd fds[2];
+	char buf[64];
+	int fd = -1;
+
+	dbus_connection_get_unix_fd(worker->conn, &fd);
+
+	while (1) {
+		fds[0].fd = fd;
+		fds[0].events = POLLIN;
+		if (dbus_connection_has_messages_to_send(worker->conn))
+			fds[0].events |= POLLOUT;
+		fds[0].revents = 0;
+
+		fds[1].fd = worker->wake_fd[0];
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+
+		if (poll(fds, 2, -1) < 0)
+			continue;
+
+		if (fds[1].revents & POLLIN)
+			while (read(worker->wake_fd[0], buf, sizeof(buf)) > 0);
+
+		while ((node = __io_queue_pop(&worker->outbox))) {
+			if (!dbus_connection_send(worker->conn, node->msg, NULL))
+				ERR("fail to send dbus message");
+			dbus_message_unref(node->msg);
+			free(node);
+		}
+
+		if (!dbus_connection_read_write(worker->conn, 0)) {
+			ERR("connection is closed");
+			break;
+		}
+
+		while (dbus_connection_dispatch(worker->conn)
+				== DBUS_DISPATCH_DATA_REMAINS);
+	}
+
+	/* the main loop joins the thread and frees the outbox */
+	__atomic_store_n(&worker->dead, 1, __ATOMIC_RELEASE);
+	ecore_pipe_write(worker->pipe, "", 1);
+
+	return NULL;
+}
+
+static DBusBusType g_bus_type = DBUS_BUS_SYSTEM;
+static char *g_bus_address;
+static DBusConnection *g_bus_shared;
+
+/* MINICONTROL_BUS selects the bus minicontrol signals travel on:
+ * "system" (default), "session" or the address of a dedicated daemon */
+static void __minictrl_bus_config(void)
+{
+	static int checked;
+	const char *env;
+
+	if (checked)
+		return;
+
+	checked = 1;
+
+	env = getenv(MINICTRL_BUS_ENV);
+	if (!env || !env[0] || !strcmp(env, "system"))
+		return;
+
+	if (!strcmp(env, "session")) {
+		g_bus_type = DBUS_BUS_SESSION;
+		INFO("use session bus");
+		return;
+	}
+
+	g_bus_address = strdup(env);
+	if (!g_bus_address) {
+		ERR("fail to alloc bus address, use system bus");
+		return;
+	}
+
+	INFO("use bus [%s]", g_bus_address);
+}
+
+static DBusConnection *__minictrl_bus_address_open(int private,
+						DBusError *err)
+{
+	DBusConnection *conn;
+
+	if (private)
+		conn = dbus_connection_open_private(g_bus_address, err);
+	else
+		conn = dbus_connection_open(g_bus_address, err);
+	if (!conn)
+		return NULL;
+
+	/* signals are routed by the daemon only to registered peers */
+	if (!dbus_bus_register(conn, err)) {
+		if (private)
+			dbus_connection_close(conn);
+		dbus_connection_unref(conn);
+		return NULL;
+	}
+
+	return conn;
+}
+
+/* returns a new reference, private connections have to be closed too */
+static DBusConnection *__minictrl_bus_get(int private, DBusError *err)
+{
+	__minictrl_bus_config();
+
+	if (!g_bus_address) {
+		if (private)
+			return dbus_bus_get_private(g_bus_type, err);
+
+		return dbus_bus_get(g_bus_type, err);
+	}
+
+	if (private)
+		return __minictrl_bus_address_open(1, err);
+
+	/* keep one reference like dbus_bus_get() does for well known buses */
+	if (g_bus_shared && !dbus_connection_get_is_connected(g_bus_shared)) {
+		dbus_connection_unref(g_bus_shared);
+		g_bus_shared = NULL;
+	}
+
+	if (!g_bus_shared)
+		g_bus_shared = __minictrl_bus_address_open(0, err);
+
+	if (!g_bus_shared)
+		return NULL;
+
+	return dbus_connection_ref(g_bus_shared);
+}
+
+static struct _minictrl_io_worker *__io_worker_get(void)
+{
+	static int checked;
+	struct _minictrl_io_worker *worker;
+	const char *env;
+	DBusError err;
+	int i;
+
+	if (g_io_worker || checked)
+		return g_io_worker;
+
+	checked = 1;
+
+	env = getenv(MINICTRL_IO_THREAD_ENV);
+	if (!env || strcmp(env, "1"))
+		return NULL;
+
+	if (!dbus_threads_init_default()) {
+		ERR("fail to init dbus threads");
+		return NULL;
+	}
+
+	worker = calloc(1, sizeof(struct _minictrl_io_worker));
+	if (!worker) {
+		ERR("fail to alloc io worker");
+		return NULL;
+	}
+
+	worker->wake_fd[0] = -1;
+	worker->wake_fd[1] = -1;
+	__io_queue_init(&worker->inbox);
+	__io_queue_init(&worker->outbox);
+	pthread_mutex_init(&worker->lock, NULL);
+
+	dbus_error_init(&err);
+	worker->conn = __minictrl_bus_get(1, &err);
+	if (!worker->conn) {
+		ERR("fail to get bus : %s", err.message);
+		goto error_n_return;
+	}
+	dbus_connection_set_exit_on_disconnect(worker->conn, FALSE);
+
+	if (!dbus_connection_add_filter(worker->conn, __io_worker_filter,
+					worker, NULL)) {
+		ERR("fail to dbus_connection_add_filter");
+		goto error_n_return;
+	}
+
+	if (pipe(worker->wake_fd) < 0) {
+		ERR("fail to create wake pipe");
+		goto error_n_return;
+	}
+	fcntl(worker->wake_fd[0], F_SETFL, O_NONBLOCK);
+	fcntl(worker->wake_fd[1], F_SETFL, O_NONBLOCK);
+
+	worker->pipe = ecore_pipe_add(__io_pipe_cb, worker);
+	if (!worker->pipe) {
+		ERR("fail to create ecore pipe");
+		goto error_n_return;
+	}
+
+	if (pthread_create(&worker->thread, NULL, __io_worker_main, worker)) {
+		ERR("fail to create io thread");
+		goto error_n_return;
+	}
+
+	INFO("minicontrol I/O thread is running");
+	g_io_worker = worker;
+
+	/* bus socket, wake pipe and Ecore pipe */
+	_minictrl_resource_add(MINICTRL_RESOURCE_CONNECTION,
+				sizeof(struct _minictrl_io_worker));
+	for (i = 0; i < 5; i++)
+		_minictrl_resource_add(MINICTRL_RESOURCE_FD, 0);
+
+	return worker;
+
+error_n_return:
+	dbus_error_free(&err);
+
+	if (worker->pipe)
+		ecore_pipe_del(worker->pipe);
+
+	if (worker->wake_fd[0] >= 0) {
+		close(worker->wake_fd[0]);
+		close(worker->wake_fd[1]);
+	}
+
+	if (worker->conn) {
+		dbus_connection_close(worker->conn);
+		dbus_connection_unref(worker->conn);
+	}
+
+	pthread_mutex_destroy(&worker->lock);
+	free(worker);
+
+	return NULL;
+}
+
+static int __minictrl_message_send(DBusMessage *message)
+{
+	struct _minictrl_io_worker *worker;
+	DBusConnection *connection = NULL;
+	DBusError err;
+	dbus_bool_t dbus_ret;
+	int ret = MINICONTROL_ERROR_NONE;
+
+	worker = __io_worker_get();
+	if (worker) {
+		struct _minictrl_io_node *node;
+
+		if (!__io_worker_alive(worker)) {
+			__io_worker_reap(worker);
+			return MINICONTROL_ERROR_DBUS;
+		}
+
+		node = malloc(sizeof(struct _minictrl_io_node));
+		if (!node) {
+			ERR("fail to alloc io node");
+			return MINICONTROL_ERROR_OUT_OF_MEMORY;
+		}
+
+		node->handle = NULL;
+		node->msg = dbus_message_ref(message);
+		__io_queue_push(&worker->outbox, node);
+
+		/* the worker may have quit before it saw the node */
+		if (!__io_worker_alive(worker)) {
+			__io_worker_reap(worker);
+			return MINICONTROL_ERROR_DBUS;
+		}
+
+		__io_worker_wakeup(worker);
+
+		return MINICONTROL_ERROR_NONE;
+	}
+
+	dbus_error_init(&err);
+
+	/* keep requests behind the match rules added on the shared
+	 * connection, e.g. answers to RUNNING_REQ are not missed */
+	if (g_sig_conn)
+		connection = dbus_connection_ref(g_sig_conn);
+	else
+		connection = __minictrl_bus_get(0, &err);
+	if (!connection) {
+		ERR("Fail to dbus_bus_get : %s", err.message);
+		dbus_error_free(&err);
+		return MINICONTROL_ERROR_DBUS;
+	}
+
+	dbus_ret = dbus_connection_send(connection, message, NULL);
+	if (!dbus_ret) {
+		ERR("fail to send dbus message");
+		ret = MINICONTROL_ERROR_DBUS;
+	} else {
+		dbus_connection_flush(connection);
+	}
+
+	dbus_error_free(&err);
+	dbus_connection_unref(connection);
+
+	return ret;
+}
+
 int _minictrl_viewer_req_message_send(void)
 {
-	DBusConnection *connection = NULL;
 	DBusMessage *message = NULL;
-	DBusError err;
-	dbus_bool_t dbus_ret;
 	int ret = MINICONTROL_ERROR_NONE;
 
-	dbus_error_init(&err);
-	connection = dbus_bus_get(DBUS_BUS_SYSTEM, &err);
-	if (!connection) {
-		ERR("Fail to dbus_bus_get : %s", err.message);
-		ret = MINICONTROL_ERROR_DBUS;
-		goto release_n_return;
+	message = dbus_message_new_signal(MINICTRL_DBUS_PATH,
+				MINICTRL_DBUS_INTERFACE,
+				MINICTRL_DBUS_SIG_RUNNING_REQ);
+	if (!message) {
+		ERR("fail to create dbus message");
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	ret = __minictrl_message_send(message);
+	if (ret != MINICONTROL_ERROR_NONE)
+		ERR("fail to send dbus viewer req message");
+	else
+		_minictrl_trace_write(MINICTRL_TRACE_DIR_SEND,
+				MINICTRL_DBUS_SIG_RUNNING_REQ, NULL, 0, 0, 0);
+
+	dbus_message_unref(message);
+
+	return ret;
+}
+
+static int __provider_message_send(const char *sig_name,
+				const char *svr_name,
+				unsigned int witdh, unsigned int height,
+				minicontrol_priority_e priority,
+				const char *category)
+{
+	DBusMessage *message = NULL;
+	dbus_bool_t dbus_ret;
+	int ret = MINICONTROL_ERROR_NONE;
+
+	if (!sig_name) {
+		ERR("sig_name is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	if (!svr_name) {
+		ERR("svr_name is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	message = dbus_message_new_signal(MINICTRL_DBUS_PATH,
+				MINICTRL_DBUS_INTERFACE,
+				sig_name);
+
+	if (!message) {
+		ERR("fail to create dbus message");
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	dbus_ret = dbus_message_append_args(message,
+			DBUS_TYPE_STRING, &svr_name,
+			DBUS_TYPE_UINT32, &witdh,
+			DBUS_TYPE_UINT32, &height,
+			DBUS_TYPE_UINT32, &priority,
+			DBUS_TYPE_INVALID);
+
+	/* optional trailing argument, older monitors ignore it */
+	if (dbus_ret && category)
+		dbus_ret = dbus_message_append_args(message,
+				DBUS_TYPE_STRING, &category,
+				DBUS_TYPE_INVALID);
+
+	if (!dbus_ret) {
+		ERR("fail to append name to dbus message : %s", svr_name);
+		ret = MINICONTROL_ERROR_OUT_OF_MEMORY;
+		goto release_n_return;
+	}
+
+	ret = __minictrl_message_send(message);
+	if (ret != MINICONTROL_ERROR_NONE) {
+		ERR("fail to send dbus message : %s", svr_name);
+		goto release_n_return;
+	}
+
+	_minictrl_trace_write(MINICTRL_TRACE_DIR_SEND, sig_name, svr_name,
+				witdh, height, priority);
+
+	INFO("[%s][%s] size-[%ux%u] priority[%u]",
+		sig_name, svr_name, witdh, height, priority);
+
+release_n_return:
+	dbus_message_unref(message);
+
+	return ret;
+}
+
+int _minictrl_provider_message_send(const char *sig_name, const char *svr_name,
+				unsigned int witdh, unsigned int height,
+				minicontrol_priority_e priority)
+{
+	return __provider_message_send(sig_name, svr_name,
+				witdh, height, priority, NULL);
+}
+
+int _minictrl_provider_start_message_send(const char *svr_name,
+				unsigned int witdh, unsigned int height,
+				minicontrol_priority_e priority,
+				const char *category)
+{
+	return __provider_message_send(MINICTRL_DBUS_SIG_START, svr_name,
+				witdh, height, priority, category);
+}
+
+int _minictrl_provider_batch_message_send(const minicontrol_event_s *events,
+				unsigned int count)
+{
+	DBusMessage *message = NULL;
+	DBusMessageIter iter;
+	DBusMessageIter array;
+	DBusMessageIter record;
+	const char *category;
+	dbus_uint32_t action;
+	dbus_uint32_t pri;
+	unsigned int i;
+	int ret = MINICONTROL_ERROR_NONE;
+
+	if (!events || !count || count > MINICTRL_BATCH_MAX) {
+		ERR("invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	message = dbus_message_new_signal(MINICTRL_DBUS_PATH,
+				MINICTRL_DBUS_INTERFACE,
+				MINICTRL_DBUS_SIG_BATCH);
+	if (!message) {
+		ERR("fail to create dbus message");
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	dbus_message_iter_init_append(message, &iter);
+	if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+						"(usuuus)", &array))
+		goto oom_n_return;
+
+	for (i = 0; i < count; i++) {
+		action = events[i].action;
+		pri = events[i].priority;
+		category = events[i].category ? events[i].category : "";
+
+		if (!dbus_message_iter_open_container(&array,
+					DBUS_TYPE_STRUCT, NULL, &record)
+			|| !dbus_message_iter_append_basic(&record,
+					DBUS_TYPE_UINT32, &action)
+			|| !dbus_message_iter_append_basic(&record,
+					DBUS_TYPE_STRING, &events[i].name)
+			|| !dbus_message_iter_append_basic(&record,
+					DBUS_TYPE_UINT32, &events[i].width)
+			|| !dbus_message_iter_append_basic(&record,
+					DBUS_TYPE_UINT32, &events[i].height)
+			|| !dbus_message_iter_append_basic(&record,
+					DBUS_TYPE_UINT32, &pri)
+			|| !dbus_message_iter_append_basic(&record,
+					DBUS_TYPE_STRING, &category)
+			|| !dbus_message_iter_close_container(&array, &record))
+			goto oom_n_return;
+	}
+
+	if (!dbus_message_iter_close_container(&iter, &array))
+		goto oom_n_return;
+
+	ret = __minictrl_message_send(message);
+	if (ret != MINICONTROL_ERROR_NONE) {
+		ERR("fail to send dbus batch message");
+		goto release_n_return;
+	}
+
+	for (i = 0; i < count; i++)
+		_minictrl_trace_write(MINICTRL_TRACE_DIR_SEND,
+				_minictrl_event_sig_name(events[i].action),
+				events[i].name, events[i].width,
+				events[i].height, events[i].priority);
+
+	INFO("[%s] %u records", MINICTRL_DBUS_SIG_BATCH, count);
+	goto release_n_return;
+
+oom_n_return:
+	ERR("fail to append batch to dbus message");
+	ret = MINICONTROL_ERROR_OUT_OF_MEMORY;
+
+release_n_return:
+	dbus_message_unref(message);
+
+	return ret;
+}
+
+int _minictrl_provider_priority_message_send(const char *svr_name,
+				minicontrol_priority_e priority)
+{
+	DBusMessage *message = NULL;
+	int ret = MINICONTROL_ERROR_NONE;
+
+	if (!svr_name) {
+		ERR("svr_name is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
 	}
 
 	message = dbus_message_new_signal(MINICTRL_DBUS_PATH,
 				MINICTRL_DBUS_INTERFACE,
-				MINICTRL_DBUS_SIG_RUNNING_REQ);
+				MINICTRL_DBUS_SIG_PRIORITY);
 	if (!message) {
 		ERR("fail to create dbus message");
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	if (!dbus_message_append_args(message,
+			DBUS_TYPE_STRING, &svr_name,
+			DBUS_TYPE_UINT32, &priority,
+			DBUS_TYPE_INVALID)) {
+		ERR("fail to append name to dbus message : %s", svr_name);
 		ret = MINICONTROL_ERROR_OUT_OF_MEMORY;
 		goto release_n_return;
 	}
 
-	dbus_ret = dbus_connection_send(connection, message, NULL);
-	if (!dbus_ret) {
-		ERR("fail to send dbus viewer req message");
-		ret = MINICONTROL_ERROR_DBUS;
+	ret = __minictrl_message_send(message);
+	if (ret != MINICONTROL_ERROR_NONE) {
+		ERR("fail to send dbus message : %s", svr_name);
 		goto release_n_return;
 	}
 
-	dbus_connection_flush(connection);
+	_minictrl_trace_write(MINICTRL_TRACE_DIR_SEND,
+			MINICTRL_DBUS_SIG_PRIORITY, svr_name, 0, 0, priority);
+
+	INFO("[%s][%s] priority[%u]",
+		MINICTRL_DBUS_SIG_PRIORITY, svr_name, priority);
 
 release_n_return:
-	dbus_error_free(&err);
+	dbus_message_unref(message);
+
+	return ret;
+}
+
+int _minictrl_priority_valid(unsigned int value)
+{
+	switch (value) {
+	case MINICONTROL_PRIORITY_TOP:
+	case MINICONTROL_PRIORITY_MIDDLE:
+	case MINICONTROL_PRIORITY_LOW:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static minicontrol_priority_e __event_priority(unsigned int value)
+{
+	if (!_minictrl_priority_valid(value))
+		return MINICTRL_PRIORITY_FALLBACK;
 
-	if (message)
-		dbus_message_unref(message);
+	return value;
+}
+
+static int __event_iter_next_uint(DBusMessageIter *iter, unsigned int *value)
+{
+	dbus_uint32_t v;
 
-	if (connection)
-		dbus_connection_unref(connection);
+	if (!dbus_message_iter_next(iter)
+		|| dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_UINT32)
+		return -1;
 
-	return ret;
+	dbus_message_iter_get_basic(iter, &v);
+	*value = v;
+
+	return 0;
 }
 
-int _minictrl_provider_message_send(const char *sig_name, const char *svr_name,
-				unsigned int witdh, unsigned int height,
-				minicontrol_priority_e priority)
+/* single pass over the arguments, anything coming from the bus
+ * is untrusted and every type is checked before it is read */
+int _minictrl_event_decode(DBusMessage *msg, minicontrol_action_e action,
+				minicontrol_event_s *event)
 {
-	DBusConnection *connection = NULL;
-	DBusMessage *message = NULL;
-	DBusError err;
-	dbus_bool_t dbus_ret;
-	int ret = MINICONTROL_ERROR_NONE;
+	DBusMessageIter iter;
+	const char *name = NULL;
+	unsigned int pri = 0;
 
-	if (!sig_name) {
-		ERR("sig_name is NULL, invaild parameter");
-		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	if (!msg || !event)
+		return -1;
+
+	memset(event, 0, sizeof(*event));
+	event->action = action;
+	event->priority = MINICTRL_PRIORITY_FALLBACK;
+
+	if (!dbus_message_iter_init(msg, &iter)
+		|| dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_STRING) {
+		ERR("fail to get args : no provider name");
+		return -1;
 	}
 
-	if (!svr_name) {
-		ERR("svr_name is NULL, invaild parameter");
-		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	dbus_message_iter_get_basic(&iter, &name);
+	if (!name || !name[0]) {
+		ERR("fail to get args : empty provider name");
+		return -1;
+	}
+
+	event->name = name;
+	event->name_len = strlen(name);
+
+	switch (action) {
+	case MINICONTROL_ACTION_START:
+	case MINICONTROL_ACTION_RESIZE:
+		if (__event_iter_next_uint(&iter, &event->width)
+			|| __event_iter_next_uint(&iter, &event->height)
+			|| __event_iter_next_uint(&iter, &pri)) {
+			ERR("fail to get args : %s", name);
+			return -1;
+		}
+		event->priority = __event_priority(pri);
+
+		/* optional trailing category */
+		if (action == MINICONTROL_ACTION_START
+			&& dbus_message_iter_next(&iter)
+			&& dbus_message_iter_get_arg_type(&iter)
+						== DBUS_TYPE_STRING)
+			dbus_message_iter_get_basic(&iter, &event->category);
+		break;
+	case MINICONTROL_ACTION_PRIORITY:
+		if (__event_iter_next_uint(&iter, &pri)) {
+			ERR("fail to get args : %s", name);
+			return -1;
+		}
+		event->priority = __event_priority(pri);
+		break;
+	case MINICONTROL_ACTION_STOP:
+		break;
+	default:
+		ERR("unknown action : %d", action);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int __event_iter_read(DBusMessageIter *iter, int type, void *value)
+{
+	if (dbus_message_iter_get_arg_type(iter) != type)
+		return -1;
+
+	dbus_message_iter_get_basic(iter, value);
+	dbus_message_iter_next(iter);
+
+	return 0;
+}
+
+static int __event_record_decode(DBusMessageIter *record,
+				minicontrol_event_s *event)
+{
+	dbus_uint32_t action = 0;
+	dbus_uint32_t w = 0;
+	dbus_uint32_t h = 0;
+	dbus_uint32_t pri = 0;
+	const char *name = NULL;
+	const char *category = NULL;
+
+	if (__event_iter_read(record, DBUS_TYPE_UINT32, &action)
+		|| __event_iter_read(record, DBUS_TYPE_STRING, &name)
+		|| __event_iter_read(record, DBUS_TYPE_UINT32, &w)
+		|| __event_iter_read(record, DBUS_TYPE_UINT32, &h)
+		|| __event_iter_read(record, DBUS_TYPE_UINT32, &pri)
+		|| __event_iter_read(record, DBUS_TYPE_STRING, &category))
+		return -1;
+
+	if (action > MINICONTROL_ACTION_PRIORITY || !name || !name[0])
+		return -1;
+
+	memset(event, 0, sizeof(*event));
+	event->action = action;
+	event->name = name;
+	event->name_len = strlen(name);
+	event->width = w;
+	event->height = h;
+	event->priority = __event_priority(pri);
+	if (action == MINICONTROL_ACTION_START && category && category[0])
+		event->category = category;
+
+	return 0;
+}
+
+int _minictrl_event_batch_decode(DBusMessage *msg,
+				minicontrol_event_s *events,
+				unsigned int max, unsigned int *count)
+{
+	DBusMessageIter iter;
+	DBusMessageIter array;
+	DBusMessageIter record;
+
+	if (!msg || !events || !count)
+		return -1;
+
+	*count = 0;
+
+	if (!dbus_message_iter_init(msg, &iter)
+		|| dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_ARRAY
+		|| dbus_message_iter_get_element_type(&iter)
+						!= DBUS_TYPE_STRUCT) {
+		ERR("fail to get args : not a batch");
+		return -1;
+	}
+
+	dbus_message_iter_recurse(&iter, &array);
+	while (dbus_message_iter_get_arg_type(&array) == DBUS_TYPE_STRUCT) {
+		if (*count == max) {
+			ERR("batch has more than %u records", max);
+			break;
+		}
+
+		dbus_message_iter_recurse(&array, &record);
+		if (!__event_record_decode(&record, &events[*count]))
+			(*count)++;
+		else
+			ERR("fail to decode batch record");
+
+		dbus_message_iter_next(&array);
+	}
+
+	return 0;
+}
+
+const char *_minictrl_event_sig_name(minicontrol_action_e action)
+{
+	switch (action) {
+	case MINICONTROL_ACTION_START:
+		return MINICTRL_DBUS_SIG_START;
+	case MINICONTROL_ACTION_STOP:
+		return MINICTRL_DBUS_SIG_STOP;
+	case MINICONTROL_ACTION_RESIZE:
+		return MINICTRL_DBUS_SIG_RESIZE;
+	case MINICONTROL_ACTION_PRIORITY:
+		return MINICTRL_DBUS_SIG_PRIORITY;
+	default:
+		return NULL;
+	}
+}
+
+/* dispatch state of a connection driven by the Ecore main loop */
+struct _minictrl_ecore_conn {
+	DBusConnection *conn;
+	Ecore_Idler *dispatcher;
+};
+
+static Eina_Bool __ecore_dispatch_cb(void *data)
+{
+	struct _minictrl_ecore_conn *ec = data;
+
+	ec->dispatcher = NULL;
+
+	dbus_connection_ref(ec->conn);
+	while (dbus_connection_dispatch(ec->conn)
+				== DBUS_DISPATCH_DATA_REMAINS)
+		;
+	dbus_connection_unref(ec->conn);
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static void __ecore_dispatch_status_cb(DBusConnection *conn,
+				DBusDispatchStatus status, void *data)
+{
+	struct _minictrl_ecore_conn *ec = data;
+
+	if (status == DBUS_DISPATCH_DATA_REMAINS && !ec->dispatcher)
+		ec->dispatcher = ecore_idler_add(__ecore_dispatch_cb, ec);
+}
+
+static void __ecore_conn_free(void *data)
+{
+	struct _minictrl_ecore_conn *ec = data;
+
+	if (ec->dispatcher)
+		ecore_idler_del(ec->dispatcher);
+
+	free(ec);
+}
+
+static Eina_Bool __ecore_watch_cb(void *data, Ecore_Fd_Handler *fd_handler)
+{
+	DBusWatch *watch = data;
+	unsigned int flags = 0;
+
+	if (ecore_main_fd_handler_active_get(fd_handler, ECORE_FD_READ))
+		flags |= DBUS_WATCH_READABLE;
+	if (ecore_main_fd_handler_active_get(fd_handler, ECORE_FD_WRITE))
+		flags |= DBUS_WATCH_WRITABLE;
+	if (ecore_main_fd_handler_active_get(fd_handler, ECORE_FD_ERROR))
+		flags |= DBUS_WATCH_ERROR;
+
+	/* incoming messages are dispatched from the status callback */
+	dbus_watch_handle(watch, flags);
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+static dbus_bool_t __ecore_watch_add(DBusWatch *watch, void *data)
+{
+	Ecore_Fd_Handler *fd_handler;
+	unsigned int flags;
+	int ecore_flags = ECORE_FD_ERROR;
+
+	if (!dbus_watch_get_enabled(watch))
+		return TRUE;
+
+	flags = dbus_watch_get_flags(watch);
+	if (flags & DBUS_WATCH_READABLE)
+		ecore_flags |= ECORE_FD_READ;
+	if (flags & DBUS_WATCH_WRITABLE)
+		ecore_flags |= ECORE_FD_WRITE;
+
+	fd_handler = ecore_main_fd_handler_add(dbus_watch_get_unix_fd(watch),
+				ecore_flags, __ecore_watch_cb, watch,
+				NULL, NULL);
+	if (!fd_handler) {
+		ERR("fail to add fd handler");
+		return FALSE;
+	}
+
+	dbus_watch_set_data(watch, fd_handler, NULL);
+
+	return TRUE;
+}
+
+static void __ecore_watch_remove(DBusWatch *watch, void *data)
+{
+	Ecore_Fd_Handler *fd_handler = dbus_watch_get_data(watch);
+
+	if (fd_handler) {
+		ecore_main_fd_handler_del(fd_handler);
+		dbus_watch_set_data(watch, NULL, NULL);
+	}
+}
+
+static void __ecore_watch_toggled(DBusWatch *watch, void *data)
+{
+	__ecore_watch_remove(watch, data);
+	__ecore_watch_add(watch, data);
+}
+
+static Eina_Bool __ecore_timeout_cb(void *data)
+{
+	dbus_timeout_handle(data);
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+static dbus_bool_t __ecore_timeout_add(DBusTimeout *timeout, void *data)
+{
+	Ecore_Timer *timer;
+
+	if (!dbus_timeout_get_enabled(timeout))
+		return TRUE;
+
+	timer = ecore_timer_add(dbus_timeout_get_interval(timeout) / 1000.0,
+				__ecore_timeout_cb, timeout);
+	if (!timer) {
+		ERR("fail to add timer");
+		return FALSE;
+	}
+
+	dbus_timeout_set_data(timeout, timer, NULL);
+
+	return TRUE;
+}
+
+static void __ecore_timeout_remove(DBusTimeout *timeout, void *data)
+{
+	Ecore_Timer *timer = dbus_timeout_get_data(timeout);
+
+	if (timer) {
+		ecore_timer_del(timer);
+		dbus_timeout_set_data(timeout, NULL, NULL);
+	}
+}
+
+static void __ecore_timeout_toggled(DBusTimeout *timeout, void *data)
+{
+	__ecore_timeout_remove(timeout, data);
+	__ecore_timeout_add(timeout, data);
+}
+
+static int __ecore_connection_setup(DBusConnection *conn)
+{
+	struct _minictrl_ecore_conn *ec;
+
+	ec = calloc(1, sizeof(struct _minictrl_ecore_conn));
+	if (!ec)
+		return -1;
+
+	ec->conn = conn;
+
+	if (!dbus_connection_set_watch_functions(conn, __ecore_watch_add,
+				__ecore_watch_remove, __ecore_watch_toggled,
+				NULL, NULL)
+		|| !dbus_connection_set_timeout_functions(conn,
+				__ecore_timeout_add, __ecore_timeout_remove,
+				__ecore_timeout_toggled, NULL, NULL)) {
+		ERR("fail to set watch functions");
+		dbus_connection_set_watch_functions(conn,
+				NULL, NULL, NULL, NULL, NULL);
+		free(ec);
+		return -1;
+	}
+
+	/* ec lives as long as the connection */
+	dbus_connection_set_dispatch_status_function(conn,
+				__ecore_dispatch_status_cb, ec,
+				__ecore_conn_free);
+
+	__ecore_dispatch_status_cb(conn,
+			dbus_connection_get_dispatch_status(conn), ec);
+
+	return 0;
+}
+
+/* connections are driven by Ecore directly, MINICONTROL_MAINLOOP=glib
+ * goes through dbus-glib instead, e.g. to compare both */
+static void __minictrl_connection_setup(DBusConnection *conn)
+{
+	static int checked;
+	static int use_glib;
+	const char *env;
+
+	if (!checked) {
+		checked = 1;
+		env = getenv(MINICTRL_MAINLOOP_ENV);
+		use_glib = env && !strcmp(env, "glib");
+		if (use_glib)
+			INFO("dispatch bus messages from the glib main loop");
+	}
+
+	if (!use_glib && !__ecore_connection_setup(conn))
+		return;
+
+	dbus_connection_setup_with_g_main(conn, NULL);
+}
+
+/* one connection is shared by all signal handles of this library,
+ * so attaching a handle costs neither a bus handshake nor a round trip */
+static DBusConnection *__sig_conn_get(DBusError *err)
+{
+	if (g_sig_conn)
+		return g_sig_conn;
+
+	g_sig_conn = __minictrl_bus_get(1, err);
+	if (!g_sig_conn)
+		return NULL;
+
+	__minictrl_connection_setup(g_sig_conn);
+	dbus_connection_set_exit_on_disconnect(g_sig_conn, FALSE);
+
+	_minictrl_resource_add(MINICTRL_RESOURCE_CONNECTION, 0);
+	_minictrl_resource_add(MINICTRL_RESOURCE_FD, 0);
+
+	return g_sig_conn;
+}
+
+static void __sig_conn_close(void)
+{
+	if (g_sig_conn_users > 0 || !g_sig_conn)
+		return;
+
+	dbus_connection_close(g_sig_conn);
+	dbus_connection_unref(g_sig_conn);
+	g_sig_conn = NULL;
+
+	_minictrl_resource_del(MINICTRL_RESOURCE_FD, 0);
+	_minictrl_resource_del(MINICTRL_RESOURCE_CONNECTION, 0);
+}
+
+static void __sig_conn_release(void)
+{
+	g_sig_conn_users--;
+	__sig_conn_close();
+}
+
+/* handles on the shared connection listening to the same signal
+ * share its match rule, signal has to be interned */
+static int __sig_conn_signal_users(const char *signal)
+{
+	minictrl_sig_handle *handle;
+	int users = 0;
+
+	for (handle = g_handles; handle; handle = handle->all_next) {
+		if (handle->conn == g_sig_conn && !handle->detached
+			&& handle->signal == signal)
+			users++;
+	}
+
+	return users;
+}
+
+static void __sig_rule(char *rule, int size, const char *signal)
+{
+	snprintf(rule, size,
+		"path='%s',type='signal',interface='%s',member='%s'",
+		MINICTRL_DBUS_PATH,
+		MINICTRL_DBUS_INTERFACE,
+		signal);
+}
+
+int _minictrl_dbus_connect(void)
+{
+	DBusError err;
+
+	if (__io_worker_get()) {
+		if (!__io_worker_alive(g_io_worker))
+			return MINICONTROL_ERROR_DBUS;
+		return MINICONTROL_ERROR_NONE;
 	}
 
 	dbus_error_init(&err);
-	connection = dbus_bus_get(DBUS_BUS_SYSTEM, &err);
-	if (!connection) {
-		ERR("Fail to dbus_bus_get : %s", err.message);
-		ret = MINICONTROL_ERROR_DBUS;
-		goto release_n_return;
+	if (!__sig_conn_get(&err)) {
+		ERR("fail to get bus : %s", err.message);
+		dbus_error_free(&err);
+		return MINICONTROL_ERROR_DBUS;
 	}
 
-	message = dbus_message_new_signal(MINICTRL_DBUS_PATH,
-				MINICTRL_DBUS_INTERFACE,
-				sig_name);
+	return MINICONTROL_ERROR_NONE;
+}
 
-	if (!message) {
-		ERR("fail to create dbus message");
-		ret = MINICONTROL_ERROR_OUT_OF_MEMORY;
-		goto release_n_return;
+/* drops a connection of _minictrl_dbus_connect() no handle was
+ * attached to, e.g. because attaching failed */
+void _minictrl_dbus_disconnect(void)
+{
+	if (g_io_worker)
+		return;
+
+	__sig_conn_close();
+}
+
+int _minictrl_dbus_bus_id_get(char *id, int size)
+{
+	DBusConnection *conn;
+	DBusError err;
+	char *bus_id;
+
+	if (!id || size <= 0)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	dbus_error_init(&err);
+	conn = __minictrl_bus_get(0, &err);
+	if (!conn) {
+		ERR("fail to get bus : %s", err.message);
+		dbus_error_free(&err);
+		return MINICONTROL_ERROR_DBUS;
 	}
 
-	dbus_ret = dbus_message_append_args(message,
-			DBUS_TYPE_STRING, &svr_name,
-			DBUS_TYPE_UINT32, &witdh,
-			DBUS_TYPE_UINT32, &height,
-			DBUS_TYPE_UINT32, &priority,
-			DBUS_TYPE_INVALID);
-	if (!dbus_ret) {
-		ERR("fail to append name to dbus message : %s", svr_name);
-		ret = MINICONTROL_ERROR_OUT_OF_MEMORY;
-		goto release_n_return;
+	bus_id = dbus_bus_get_id(conn, &err);
+	dbus_connection_unref(conn);
+	if (!bus_id) {
+		ERR("fail to get bus id : %s", err.message);
+		dbus_error_free(&err);
+		return MINICONTROL_ERROR_DBUS;
+	}
+
+	snprintf(id, size, "%s", bus_id);
+	dbus_free(bus_id);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+/* one ListNames call, however many names are asked for */
+int _minictrl_dbus_names_alive(const char **names, unsigned int count,
+				int *alive)
+{
+	DBusConnection *conn;
+	DBusMessage *msg;
+	DBusMessage *reply;
+	DBusMessageIter iter;
+	DBusMessageIter array;
+	DBusError err;
+	Eina_Hash *owned;
+	const char *name;
+	unsigned int i;
+
+	if (!names || !alive)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	memset(alive, 0, count * sizeof(int));
+	if (!count)
+		return MINICONTROL_ERROR_NONE;
+
+	dbus_error_init(&err);
+	conn = __minictrl_bus_get(0, &err);
+	if (!conn) {
+		ERR("fail to get bus : %s", err.message);
+		dbus_error_free(&err);
+		return MINICONTROL_ERROR_DBUS;
 	}
 
-	dbus_ret = dbus_connection_send(connection, message, NULL);
-	if (!dbus_ret) {
-		ERR("fail to send dbus message : %s", svr_name);
-		ret = MINICONTROL_ERROR_DBUS;
-		goto release_n_return;
+	msg = dbus_message_new_method_call(DBUS_SERVICE_DBUS, DBUS_PATH_DBUS,
+					DBUS_INTERFACE_DBUS, "ListNames");
+	if (!msg) {
+		dbus_connection_unref(conn);
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
 	}
 
-	dbus_connection_flush(connection);
-	INFO("[%s][%s] size-[%ux%u] priority[%u]",
-		sig_name, svr_name, witdh, height, priority);
+	reply = dbus_connection_send_with_reply_and_block(conn, msg,
+				-1, &err);
+	dbus_message_unref(msg);
+	dbus_connection_unref(conn);
+	if (!reply) {
+		ERR("fail to list names : %s", err.message);
+		dbus_error_free(&err);
+		return MINICONTROL_ERROR_DBUS;
+	}
 
-release_n_return:
-	dbus_error_free(&err);
+	owned = eina_hash_string_superfast_new(NULL);
+	if (!owned) {
+		dbus_message_unref(reply);
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	if (dbus_message_iter_init(reply, &iter)
+		&& dbus_message_iter_get_arg_type(&iter) == DBUS_TYPE_ARRAY) {
+		dbus_message_iter_recurse(&iter, &array);
+		while (dbus_message_iter_get_arg_type(&array)
+						== DBUS_TYPE_STRING) {
+			dbus_message_iter_get_basic(&array, &name);
+			eina_hash_add(owned, name, name);
+			dbus_message_iter_next(&array);
+		}
+	}
 
-	if (message)
-		dbus_message_unref(message);
+	for (i = 0; i < count; i++)
+		alive[i] = names[i] && eina_hash_find(owned, names[i]) != NULL;
 
-	if (connection)
-		dbus_connection_unref(connection);
+	eina_hash_free(owned);
+	dbus_message_unref(reply);
 
-	return ret;
+	return MINICONTROL_ERROR_NONE;
 }
 
 static DBusHandlerResult _minictrl_signal_filter(DBusConnection *conn,
@@ -180,17 +1579,80 @@ static DBusHandlerResult _minictrl_signal_filter(DBusConnection *conn,
 		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
 	}
 
-	if (handle->callback)
+	if (handle->callback) {
+		_minictrl_trace_message(MINICTRL_TRACE_DIR_RECV, msg);
 		handle->callback(handle->user_data, msg);
+	}
 
-	return DBUS_HANDLER_RESULT_HANDLED;
+	/* other handles on the shared connection may wait for it too */
+	return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+
+static minictrl_sig_handle *__io_worker_sig_handle_attach(
+				struct _minictrl_io_worker *worker,
+				minictrl_sig_handle *handle)
+{
+	char rule[1024] = {'\0', };
+
+	snprintf(rule, 1024,
+		"path='%s',type='signal',interface='%s',member='%s'",
+		MINICTRL_DBUS_PATH,
+		MINICTRL_DBUS_INTERFACE,
+		handle->signal);
+
+	/* do not block on the reply, the worker thread reads the bus */
+	dbus_bus_add_match(worker->conn, rule, NULL);
+	__io_worker_wakeup(worker);
+
+	handle->conn = worker->conn;
+
+	pthread_mutex_lock(&worker->lock);
+	handle->next = worker->handles;
+	worker->handles = handle;
+	pthread_mutex_unlock(&worker->lock);
+
+	__sig_handle_register(handle);
+	_minictrl_resource_add(MINICTRL_RESOURCE_MATCH, 0);
+
+	return handle;
 }
 
+static void __io_worker_sig_handle_dettach(struct _minictrl_io_worker *worker,
+				minictrl_sig_handle *handle)
+{
+	minictrl_sig_handle **prev;
+	char rule[1024] = {'\0', };
+
+	pthread_mutex_lock(&worker->lock);
+	for (prev = &worker->handles; *prev; prev = &(*prev)->next) {
+		if (*prev == handle) {
+			*prev = handle->next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&worker->lock);
+
+	snprintf(rule, 1024,
+		"path='%s',type='signal',interface='%s',member='%s'",
+		MINICTRL_DBUS_PATH,
+		MINICTRL_DBUS_INTERFACE,
+		handle->signal);
+
+	dbus_bus_remove_match(worker->conn, rule, NULL);
+	__io_worker_wakeup(worker);
+	_minictrl_resource_del(MINICTRL_RESOURCE_MATCH, 0);
+
+	/* messages already queued for this handle are dropped */
+	handle->detached = 1;
+	__sig_handle_unref(handle);
+}
 
 minictrl_sig_handle *_minictrl_dbus_sig_handle_attach(const char *signal,
 				void (*callback) (void *data, DBusMessage *msg),
 				void *data)
 {
+	struct _minictrl_io_worker *worker;
 	minictrl_sig_handle *handle = NULL;
 	DBusError err;
 	DBusConnection *conn = NULL;
@@ -206,46 +1668,54 @@ minictrl_sig_handle *_minictrl_dbus_sig_handle_attach(const char *signal,
 		return NULL;
 	}
 
-	handle = malloc(sizeof(minictrl_sig_handle));
+	handle = __sig_handle_new(signal);
 	if (!handle) {
 		ERR("fail to alloc handle");
 		return NULL;
 	}
 
-	dbus_error_init(&err);
-	conn = dbus_bus_get_private(DBUS_BUS_SYSTEM, &err);
-	if (!conn) {
-		ERR("fail to get bus : %s", err.message);
-		goto error_n_return;
+	handle->callback = callback;
+	handle->user_data = data;
+	handle->ref = 1;
+
+	worker = __io_worker_get();
+	if (worker && !__io_worker_alive(worker)) {
+		ERR("I/O thread lost the bus connection");
+		__sig_handle_free(handle);
+		return NULL;
 	}
 
-	dbus_connection_setup_with_g_main(conn, NULL);
-	snprintf(rule, 1024,
-		"path='%s',type='signal',interface='%s',member='%s'",
-		MINICTRL_DBUS_PATH,
-		MINICTRL_DBUS_INTERFACE,
-		signal);
+	if (worker) {
+		INFO("attach signal[%s]-[%p, %p] to I/O thread",
+				signal, callback, data);
+		return __io_worker_sig_handle_attach(worker, handle);
+	}
 
-	dbus_bus_add_match(conn, rule, &err);
-	if (dbus_error_is_set(&err)) {
-		ERR("fail to dbus_bus_remove_match : %s",
-				err.message);
+	dbus_error_init(&err);
+	conn = __sig_conn_get(&err);
+	if (!conn) {
+		ERR("fail to get bus : %s", err.message);
 		goto error_n_return;
 	}
 
 	if (dbus_connection_add_filter(conn, _minictrl_signal_filter,
 					handle, NULL) == FALSE) {
-		ERR("fail to dbus_connection_add_filter : %s",
-				err.message);
+		ERR("fail to dbus_connection_add_filter");
 		goto error_n_return;
 	}
 
-	dbus_connection_set_exit_on_disconnect(conn, FALSE);
+	/* do not wait for the reply, requests sent later on this
+	 * connection are handled by the bus after the match rule */
+	if (!__sig_conn_signal_users(handle->signal)) {
+		__sig_rule(rule, sizeof(rule), signal);
+		dbus_bus_add_match(conn, rule, NULL);
+		_minictrl_resource_add(MINICTRL_RESOURCE_MATCH, 0);
+	}
 
 	handle->conn = conn;
-	handle->callback = callback;
-	handle->user_data = data;
-	handle->signal = strdup(signal);
+	g_sig_conn_users++;
+
+	__sig_handle_register(handle);
 
 	INFO("success to attach signal[%s]-[%p, %p]", signal, callback, data);
 
@@ -254,19 +1724,15 @@ minictrl_sig_handle *_minictrl_dbus_sig_handle_attach(const char *signal,
 
 error_n_return:
 	if (handle)
-		free(handle);
+		__sig_handle_free(handle);
 
 	dbus_error_free(&err);
 
-	if (conn)
-		dbus_connection_close(conn);
-
 	return NULL;
 }
 
 void _minictrl_dbus_sig_handle_dettach(minictrl_sig_handle *handle)
 {
-	DBusError err;
 	char rule[1024] = {'\0', };
 
 	if (!handle) {
@@ -274,28 +1740,448 @@ void _minictrl_dbus_sig_handle_dettach(minictrl_sig_handle *handle)
 		return;
 	}
 
-	dbus_error_init(&err);
+	if (g_io_worker && handle->conn == g_io_worker->conn) {
+		__io_worker_sig_handle_dettach(g_io_worker, handle);
+		return;
+	}
 
 	dbus_connection_remove_filter(handle->conn,
 			_minictrl_signal_filter, handle);
 
-	snprintf(rule, 1024,
-		"path='%s',type='signal',interface='%s',member='%s'",
-		MINICTRL_DBUS_PATH,
-		MINICTRL_DBUS_INTERFACE,
-		handle->signal);
+	handle->detached = 1;
+	if (!__sig_conn_signal_users(handle->signal)) {
+		__sig_rule(rule, sizeof(rule), handle->signal);
+		dbus_bus_remove_match(handle->conn, rule, NULL);
+		_minictrl_resource_del(MINICTRL_RESOURCE_MATCH, 0);
+	}
+
+	__sig_conn_release();
+	__sig_handle_unref(handle);
+}
+
+struct _minictrl_name_watch {
+	DBusConnection *conn;
+	void (*callback) (void *data, const char *name);
+	void *user_data;
+	Eina_Hash *names; /* names with a match rule on the bus */
+	Eina_List *pending; /* AddMatch and NameHasOwner not answered yet */
+};
+
+/* reply of a call about one watched name */
+struct _minictrl_name_watch_call {
+	minictrl_name_watch *watch;
+	DBusPendingCall *pending;
+	char *name;
+};
+
+static DBusHandlerResult _minictrl_name_watch_filter(DBusConnection *conn,
+		DBusMessage *msg, void *user_data)
+{
+	minictrl_name_watch *watch = user_data;
+	const char *name = NULL;
+	const char *old_owner = NULL;
+	const char *new_owner = NULL;
+	DBusError err;
+
+	if (!dbus_message_is_signal(msg, DBUS_INTERFACE_DBUS,
+					"NameOwnerChanged"))
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	dbus_error_init(&err);
+	if (!dbus_message_get_args(msg, &err,
+				DBUS_TYPE_STRING, &name,
+				DBUS_TYPE_STRING, &old_owner,
+				DBUS_TYPE_STRING, &new_owner,
+				DBUS_TYPE_INVALID)) {
+		ERR("fail to get args : %s", err.message);
+		dbus_error_free(&err);
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+	}
+
+	/* only vanished names are interesting */
+	if (new_owner[0] != '\0')
+		return DBUS_HANDLER_RESULT_HANDLED;
+
+	/* a rule removed meanwhile may still deliver its last signal */
+	if (!eina_hash_find(watch->names, name))
+		return DBUS_HANDLER_RESULT_HANDLED;
+
+	INFO("name[%s] is gone", name);
+
+	if (watch->callback)
+		watch->callback(watch->user_data, name);
+
+	return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+minictrl_name_watch *_minictrl_dbus_name_watch_attach(
+				void (*callback) (void *data, const char *name),
+				void *data)
+{
+	minictrl_name_watch *watch;
+
+	if (!callback) {
+		ERR("callback is NULL");
+		return NULL;
+	}
+
+	watch = calloc(1, sizeof(minictrl_name_watch));
+	if (!watch) {
+		ERR("fail to alloc watch");
+		return NULL;
+	}
+
+	watch->names = eina_hash_string_superfast_new(NULL);
+	if (!watch->names) {
+		ERR("fail to alloc watch");
+		free(watch);
+		return NULL;
+	}
+
+	watch->callback = callback;
+	watch->user_data = data;
+
+	_minictrl_resource_add(MINICTRL_RESOURCE_CONNECTION,
+				sizeof(minictrl_name_watch));
 
-	dbus_bus_remove_match(handle->conn, rule, &err);
-	if (dbus_error_is_set(&err)) {
-		ERR("fail to dbus_bus_remove_match : %s", err.message);
+	return watch;
+}
+
+/* connected on the first name, nothing to watch before */
+static int __name_watch_connect(minictrl_name_watch *watch)
+{
+	DBusError err;
+
+	if (watch->conn)
+		return MINICONTROL_ERROR_NONE;
+
+	dbus_error_init(&err);
+	watch->conn = __minictrl_bus_get(1, &err);
+	if (!watch->conn) {
+		ERR("fail to get bus : %s", err.message);
+		dbus_error_free(&err);
+		return MINICONTROL_ERROR_DBUS;
+	}
+
+	__minictrl_connection_setup(watch->conn);
+	dbus_connection_set_exit_on_disconnect(watch->conn, FALSE);
+
+	if (!dbus_connection_add_filter(watch->conn,
+				_minictrl_name_watch_filter, watch, NULL)) {
+		ERR("fail to dbus_connection_add_filter");
+		dbus_connection_close(watch->conn);
+		dbus_connection_unref(watch->conn);
+		watch->conn = NULL;
+		return MINICONTROL_ERROR_DBUS;
+	}
+
+	_minictrl_resource_add(MINICTRL_RESOURCE_FD, 0);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+static void __name_watch_rule(char *rule, int size, const char *name)
+{
+	snprintf(rule, size,
+		"type='signal',sender='%s',path='%s',interface='%s',"
+		"member='NameOwnerChanged',arg0='%s'",
+		DBUS_SERVICE_DBUS, DBUS_PATH_DBUS, DBUS_INTERFACE_DBUS,
+		name);
+}
+
+static void __name_watch_call_free(void *data)
+{
+	struct _minictrl_name_watch_call *call = data;
+
+	free(call->name);
+	free(call);
+}
+
+static void __name_watch_call_done(struct _minictrl_name_watch_call *call,
+				DBusMessage **reply)
+{
+	minictrl_name_watch *watch = call->watch;
+
+	watch->pending = eina_list_remove(watch->pending, call->pending);
+	*reply = dbus_pending_call_steal_reply(call->pending);
+	dbus_pending_call_unref(call->pending);
+}
+
+static void __name_watch_drop(minictrl_name_watch *watch, const char *name)
+{
+	if (!eina_hash_del_by_key(watch->names, name))
+		return;
+
+	_minictrl_resource_del(MINICTRL_RESOURCE_MATCH, 0);
+}
+
+static void __name_watch_add_match_cb(DBusPendingCall *pending, void *data)
+{
+	struct _minictrl_name_watch_call *call = data;
+	DBusMessage *reply = NULL;
+	DBusError err;
+
+	__name_watch_call_done(call, &reply);
+	if (!reply)
+		return;
+
+	dbus_error_init(&err);
+	if (dbus_set_error_from_message(&err, reply)) {
+		ERR("fail to watch name[%s] : %s", call->name, err.message);
+		dbus_error_free(&err);
+		__name_watch_drop(call->watch, call->name);
+	}
+
+	dbus_message_unref(reply);
+}
+
+/* the daemon answers after the rule is in place, so a name that is
+ * gone here would not be reported by NameOwnerChanged anymore */
+static void __name_watch_owner_cb(DBusPendingCall *pending, void *data)
+{
+	struct _minictrl_name_watch_call *call = data;
+	minictrl_name_watch *watch = call->watch;
+	DBusMessage *reply = NULL;
+	dbus_bool_t has_owner = TRUE;
+	DBusError err;
+
+	__name_watch_call_done(call, &reply);
+	if (!reply)
+		return;
+
+	dbus_error_init(&err);
+	if (!dbus_message_get_args(reply, &err,
+				DBUS_TYPE_BOOLEAN, &has_owner,
+				DBUS_TYPE_INVALID)) {
+		ERR("fail to check name[%s] : %s", call->name, err.message);
 		dbus_error_free(&err);
 	}
+	dbus_message_unref(reply);
+
+	if (has_owner || !eina_hash_find(watch->names, call->name))
+		return;
+
+	INFO("name[%s] is gone before it was watched", call->name);
+
+	if (watch->callback)
+		watch->callback(watch->user_data, call->name);
+}
+
+static int __name_watch_call(minictrl_name_watch *watch, const char *method,
+			const char *arg, const char *name,
+			DBusPendingCallNotifyFunction notify)
+{
+	struct _minictrl_name_watch_call *call;
+	DBusMessage *msg;
+	int ret = MINICONTROL_ERROR_OUT_OF_MEMORY;
+
+	call = calloc(1, sizeof(struct _minictrl_name_watch_call));
+	if (!call)
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+
+	call->watch = watch;
+	call->name = strdup(name);
+
+	msg = dbus_message_new_method_call(DBUS_SERVICE_DBUS, DBUS_PATH_DBUS,
+					DBUS_INTERFACE_DBUS, method);
+	if (!call->name || !msg
+		|| !dbus_message_append_args(msg, DBUS_TYPE_STRING, &arg,
+						DBUS_TYPE_INVALID))
+		goto error_n_return;
+
+	if (!dbus_connection_send_with_reply(watch->conn, msg,
+					&call->pending, -1)
+		|| !call->pending) {
+		ret = MINICONTROL_ERROR_DBUS;
+		goto error_n_return;
+	}
+	dbus_message_unref(msg);
+
+	if (!dbus_pending_call_set_notify(call->pending, notify, call,
+					__name_watch_call_free)) {
+		dbus_pending_call_cancel(call->pending);
+		dbus_pending_call_unref(call->pending);
+		__name_watch_call_free(call);
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	watch->pending = eina_list_append(watch->pending, call->pending);
+
+	return MINICONTROL_ERROR_NONE;
+
+error_n_return:
+	if (msg)
+		dbus_message_unref(msg);
+	__name_watch_call_free(call);
+
+	return ret;
+}
+
+/* the rule and the check of the owner are not waited for, the owner
+ * is reported gone if it vanished before the rule was in place */
+int _minictrl_dbus_name_watch_add(minictrl_name_watch *watch,
+				const char *name)
+{
+	char rule[1024] = {'\0', };
+	int ret;
+
+	if (!watch || !name)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	if (eina_hash_find(watch->names, name))
+		return MINICONTROL_ERROR_NONE;
+
+	if (__name_watch_connect(watch) != MINICONTROL_ERROR_NONE)
+		return MINICONTROL_ERROR_DBUS;
+
+	__name_watch_rule(rule, sizeof(rule), name);
+
+	ret = __name_watch_call(watch, "AddMatch", rule, name,
+				__name_watch_add_match_cb);
+	if (ret != MINICONTROL_ERROR_NONE) {
+		ERR("fail to watch name[%s]", name);
+		return ret;
+	}
+
+	eina_hash_add(watch->names, name, watch);
+	_minictrl_resource_add(MINICTRL_RESOURCE_MATCH, 0);
+
+	if (__name_watch_call(watch, "NameHasOwner", name, name,
+				__name_watch_owner_cb) != MINICONTROL_ERROR_NONE)
+		WARN("fail to check owner of name[%s]", name);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+void _minictrl_dbus_name_watch_remove(minictrl_name_watch *watch,
+				const char *name)
+{
+	char rule[1024] = {'\0', };
+
+	if (!watch || !name || !watch->conn)
+		return;
+
+	/* removed already, e.g. the owner was reported gone */
+	if (!eina_hash_find(watch->names, name))
+		return;
+
+	__name_watch_rule(rule, sizeof(rule), name);
+
+	/* the owner is gone or not interesting anymore, do not wait */
+	dbus_bus_remove_match(watch->conn, rule, NULL);
+
+	__name_watch_drop(watch, name);
+}
+
+void _minictrl_dbus_name_watch_dettach(minictrl_name_watch *watch)
+{
+	DBusPendingCall *pending;
+	int count;
+
+	if (!watch)
+		return;
+
+	/* notify data refers to the watch, free it without a reply */
+	EINA_LIST_FREE(watch->pending, pending) {
+		dbus_pending_call_cancel(pending);
+		dbus_pending_call_unref(pending);
+	}
+
+	if (watch->conn) {
+		dbus_connection_remove_filter(watch->conn,
+				_minictrl_name_watch_filter, watch);
+
+		/* closing the connection drops its match rules as well */
+		dbus_connection_close(watch->conn);
+		dbus_connection_unref(watch->conn);
+		_minictrl_resource_del(MINICTRL_RESOURCE_FD, 0);
+	}
+
+	for (count = eina_hash_population(watch->names); count > 0; count--)
+		_minictrl_resource_del(MINICTRL_RESOURCE_MATCH, 0);
+	eina_hash_free(watch->names);
+	_minictrl_resource_del(MINICTRL_RESOURCE_CONNECTION,
+				sizeof(minictrl_name_watch));
+
+	free(watch);
+}
+
+/* falls back to a directory in /tmp named by uid without a session,
+ * anything not owned by us or open to others is refused */
+int _minictrl_runtime_dir_get(char *path, int size)
+{
+	static char dir[PATH_MAX];
+	const char *base;
+	struct stat st;
+	int len;
+
+	if (!path || size <= 0)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	if (!dir[0]) {
+		base = getenv("XDG_RUNTIME_DIR");
+		if (base && base[0] == '/')
+			len = snprintf(dir, sizeof(dir), "%s/%s", base,
+					MINICTRL_RUNTIME_DIR);
+		else
+			len = snprintf(dir, sizeof(dir), "/tmp/.%s-%u",
+					MINICTRL_RUNTIME_DIR,
+					(unsigned int)geteuid());
+		if (len < 0 || len >= (int)sizeof(dir)) {
+			dir[0] = '\0';
+			return MINICONTROL_ERROR_INVALID_PARAMETER;
+		}
 
-	dbus_connection_close(handle->conn);
+		if (mkdir(dir, 0700) < 0 && errno != EEXIST) {
+			ERR("fail to create %s", dir);
+			dir[0] = '\0';
+			return MINICONTROL_ERROR_UNKNOWN;
+		}
 
-	free(handle->signal);
-	free(handle);
+		if (lstat(dir, &st) < 0 || !S_ISDIR(st.st_mode)
+			|| st.st_uid != geteuid()
+			|| (st.st_mode & (S_IRWXG | S_IRWXO))) {
+			ERR("%s is not a private directory", dir);
+			dir[0] = '\0';
+			return MINICONTROL_ERROR_UNKNOWN;
+		}
+	}
+
+	if (snprintf(path, size, "%s", dir) >= size)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
 
-	return;
+	return MINICONTROL_ERROR_NONE;
 }
 
+int _minictrl_runtime_open(const char *file, int flags, mode_t mode)
+{
+	char path[PATH_MAX];
+	struct stat st;
+	int len;
+	int fd;
+
+	if (!file)
+		return -1;
+
+	if (_minictrl_runtime_dir_get(path, sizeof(path))
+			!= MINICONTROL_ERROR_NONE)
+		return -1;
+
+	len = strlen(path);
+	if (snprintf(path + len, sizeof(path) - len, "/%s", file)
+			>= (int)sizeof(path) - len)
+		return -1;
+
+	fd = open(path, flags | O_NOFOLLOW | O_CLOEXEC, mode);
+	if (fd < 0)
+		return -1;
+
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)
+		|| st.st_uid != geteuid()) {
+		ERR("%s is not a regular file of this user", path);
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
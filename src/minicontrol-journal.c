@@ -0,0 +1,358 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <Eina.h>
+
+#include "minicontrol-error.h"
+#include "minicontrol-internal.h"
+#include "minicontrol-log.h"
+
+/* in the runtime directory of the user */
+#define MINICTRL_JOURNAL_FILE "monitor-journal"
+#define MINICTRL_JOURNAL_MAGIC 0x4e4a434d /* "MCJN" */
+#define MINICTRL_JOURNAL_VERSION 1
+/* largest window size evas can handle */
+#define MINICTRL_JOURNAL_SIZE_MAX 32767
+
+enum {
+	MINICTRL_JOURNAL_OP_SET = 1,
+	MINICTRL_JOURNAL_OP_DEL,
+};
+
+/*
+ * Append only file of fixed size records. A record sets or deletes the
+ * state of one provider, the latest record of a name wins. A record cut
+ * short by a crash is ignored. The header ties the records to one bus,
+ * senders are unique names and mean nothing on another bus instance.
+ */
+struct _minictrl_journal_header {
+	uint32_t magic;
+	uint32_t version;
+	char bus_id[MINICTRL_JOURNAL_BUS_ID_MAX];
+};
+
+struct _minictrl_journal_record {
+	uint32_t op;
+	uint32_t width;
+	uint32_t height;
+	uint32_t priority;
+	char name[MINICONTROL_STATE_NAME_MAX];
+	char sender[MINICTRL_JOURNAL_SENDER_MAX];
+	char category[MINICTRL_JOURNAL_CATEGORY_MAX];
+};
+
+static int g_journal_fd = -1;
+static unsigned int g_journal_records;
+
+static int __journal_write(const void *buf, size_t size)
+{
+	if (write(g_journal_fd, buf, size) != (ssize_t)size) {
+		ERR("fail to write %s", MINICTRL_JOURNAL_FILE);
+		return MINICONTROL_ERROR_UNKNOWN;
+	}
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+static int __journal_reset(const char *bus_id)
+{
+	struct _minictrl_journal_header header;
+
+	if (ftruncate(g_journal_fd, 0) < 0)
+		return MINICONTROL_ERROR_UNKNOWN;
+
+	memset(&header, 0, sizeof(header));
+	header.magic = MINICTRL_JOURNAL_MAGIC;
+	header.version = MINICTRL_JOURNAL_VERSION;
+	snprintf(header.bus_id, sizeof(header.bus_id), "%s", bus_id);
+
+	g_journal_records = 0;
+
+	return __journal_write(&header, sizeof(header));
+}
+
+/* the file is private, but a record may still be from a broken write */
+static int __journal_record_valid(const struct _minictrl_journal_record *rec)
+{
+	return rec->name[0] != '\0'
+		&& _minictrl_priority_valid(rec->priority)
+		&& rec->width <= MINICTRL_JOURNAL_SIZE_MAX
+		&& rec->height <= MINICTRL_JOURNAL_SIZE_MAX;
+}
+
+static void __journal_entry_from_record(minictrl_journal_entry *entry,
+				const struct _minictrl_journal_record *rec)
+{
+	memcpy(entry->name, rec->name, sizeof(entry->name));
+	entry->name[sizeof(entry->name) - 1] = '\0';
+	memcpy(entry->sender, rec->sender, sizeof(entry->sender));
+	entry->sender[sizeof(entry->sender) - 1] = '\0';
+	memcpy(entry->category, rec->category, sizeof(entry->category));
+	entry->category[sizeof(entry->category) - 1] = '\0';
+	entry->width = rec->width;
+	entry->height = rec->height;
+	entry->priority = rec->priority;
+}
+
+/* replays the records into the latest state of each provider */
+static int __journal_load(minictrl_journal_entry **entries,
+			unsigned int *count)
+{
+	struct _minictrl_journal_record rec;
+	minictrl_journal_entry *list = NULL;
+	minictrl_journal_entry *tmp;
+	unsigned int size = 0;
+	unsigned int n = 0;
+	unsigned int index;
+	Eina_Hash *names;
+	void *found;
+
+	names = eina_hash_string_superfast_new(NULL);
+	if (!names)
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+
+	while (read(g_journal_fd, &rec, sizeof(rec)) == sizeof(rec)) {
+		g_journal_records++;
+		rec.name[sizeof(rec.name) - 1] = '\0';
+
+		/* index + 1, so 0 is not found */
+		found = eina_hash_find(names, rec.name);
+
+		if (rec.op == MINICTRL_JOURNAL_OP_DEL) {
+			if (!found)
+				continue;
+
+			index = (uintptr_t)found - 1;
+			eina_hash_del_by_key(names, rec.name);
+
+			/* keep the list dense, move the last entry here */
+			if (index != --n) {
+				list[index] = list[n];
+				eina_hash_modify(names, list[index].name,
+					(void *)(uintptr_t)(index + 1));
+			}
+			continue;
+		}
+
+		if (rec.op != MINICTRL_JOURNAL_OP_SET)
+			continue;
+
+		if (!__journal_record_valid(&rec)) {
+			WARN("drop broken record of %s", rec.name);
+			continue;
+		}
+
+		if (found) {
+			__journal_entry_from_record(
+				&list[(uintptr_t)found - 1], &rec);
+			continue;
+		}
+
+		if (n == size) {
+			size = size ? size * 2 : 32;
+			tmp = realloc(list, size * sizeof(*list));
+			if (!tmp) {
+				free(list);
+				eina_hash_free(names);
+				return MINICONTROL_ERROR_OUT_OF_MEMORY;
+			}
+			list = tmp;
+		}
+
+		__journal_entry_from_record(&list[n], &rec);
+		eina_hash_add(names, list[n].name, (void *)(uintptr_t)(n + 1));
+		n++;
+	}
+
+	eina_hash_free(names);
+
+	/* cut a record torn by a crash, records appended later would
+	 * be read shifted otherwise */
+	if (ftruncate(g_journal_fd, sizeof(struct _minictrl_journal_header)
+			+ (off_t)g_journal_records * sizeof(rec)) < 0) {
+		ERR("fail to truncate %s", MINICTRL_JOURNAL_FILE);
+		free(list);
+		return MINICONTROL_ERROR_UNKNOWN;
+	}
+
+	*entries = list;
+	*count = n;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+int _minictrl_journal_open(const char *bus_id,
+			minictrl_journal_entry **entries,
+			unsigned int *count)
+{
+	struct _minictrl_journal_header header;
+	int ret;
+
+	if (!bus_id || !entries || !count)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	*entries = NULL;
+	*count = 0;
+
+	if (g_journal_fd >= 0)
+		return MINICONTROL_ERROR_NONE;
+
+	g_journal_fd = _minictrl_runtime_open(MINICTRL_JOURNAL_FILE,
+				O_RDWR | O_CREAT | O_APPEND, 0600);
+	if (g_journal_fd < 0) {
+		ERR("fail to open %s", MINICTRL_JOURNAL_FILE);
+		return MINICONTROL_ERROR_UNKNOWN;
+	}
+
+	/* records of two monitors would be mixed up */
+	if (flock(g_journal_fd, LOCK_EX | LOCK_NB) < 0) {
+		WARN("%s is used by another monitor", MINICTRL_JOURNAL_FILE);
+		close(g_journal_fd);
+		g_journal_fd = -1;
+		return MINICONTROL_ERROR_UNKNOWN;
+	}
+
+	g_journal_records = 0;
+
+	if (read(g_journal_fd, &header, sizeof(header)) != sizeof(header)
+		|| header.magic != MINICTRL_JOURNAL_MAGIC
+		|| header.version != MINICTRL_JOURNAL_VERSION
+		|| strncmp(header.bus_id, bus_id, sizeof(header.bus_id))) {
+		INFO("no journal of this bus, start a new one");
+		ret = __journal_reset(bus_id);
+	} else {
+		ret = __journal_load(entries, count);
+	}
+
+	if (ret != MINICONTROL_ERROR_NONE)
+		_minictrl_journal_close();
+
+	return ret;
+}
+
+void _minictrl_journal_close(void)
+{
+	if (g_journal_fd < 0)
+		return;
+
+	/* closing drops the lock */
+	close(g_journal_fd);
+	g_journal_fd = -1;
+}
+
+/* only the monitor holding the journal may remove it */
+void _minictrl_journal_remove(void)
+{
+	char path[PATH_MAX];
+	int len;
+
+	if (g_journal_fd < 0)
+		return;
+
+	if (_minictrl_runtime_dir_get(path, sizeof(path))
+			== MINICONTROL_ERROR_NONE) {
+		len = strlen(path);
+		snprintf(path + len, sizeof(path) - len,
+				"/" MINICTRL_JOURNAL_FILE);
+		unlink(path);
+	}
+
+	_minictrl_journal_close();
+}
+
+static void __journal_record_from_entry(struct _minictrl_journal_record *rec,
+				const minictrl_journal_entry *entry)
+{
+	memset(rec, 0, sizeof(*rec));
+	rec->op = MINICTRL_JOURNAL_OP_SET;
+	rec->width = entry->width;
+	rec->height = entry->height;
+	rec->priority = entry->priority;
+	snprintf(rec->name, sizeof(rec->name), "%s", entry->name);
+	snprintf(rec->sender, sizeof(rec->sender), "%s", entry->sender);
+	snprintf(rec->category, sizeof(rec->category), "%s", entry->category);
+}
+
+int _minictrl_journal_set(const minictrl_journal_entry *entry)
+{
+	struct _minictrl_journal_record rec;
+
+	if (g_journal_fd < 0)
+		return MINICONTROL_ERROR_NONE;
+
+	__journal_record_from_entry(&rec, entry);
+	g_journal_records++;
+
+	return __journal_write(&rec, sizeof(rec));
+}
+
+int _minictrl_journal_del(const char *name)
+{
+	struct _minictrl_journal_record rec;
+
+	if (g_journal_fd < 0)
+		return MINICONTROL_ERROR_NONE;
+
+	memset(&rec, 0, sizeof(rec));
+	rec.op = MINICTRL_JOURNAL_OP_DEL;
+	snprintf(rec.name, sizeof(rec.name), "%s", name);
+	g_journal_records++;
+
+	return __journal_write(&rec, sizeof(rec));
+}
+
+unsigned int _minictrl_journal_record_count(void)
+{
+	return g_journal_records;
+}
+
+/* a crash in the middle only loses the journal, not the monitor state */
+int _minictrl_journal_rewrite(const char *bus_id,
+			const minictrl_journal_entry *entries,
+			unsigned int count)
+{
+	struct _minictrl_journal_record *recs;
+	unsigned int i;
+	int ret;
+
+	if (g_journal_fd < 0)
+		return MINICONTROL_ERROR_NONE;
+
+	ret = __journal_reset(bus_id);
+	if (ret != MINICONTROL_ERROR_NONE || !count)
+		return ret;
+
+	recs = malloc(count * sizeof(*recs));
+	if (!recs)
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+
+	for (i = 0; i < count; i++)
+		__journal_record_from_entry(&recs[i], &entries[i]);
+
+	ret = __journal_write(recs, count * sizeof(*recs));
+	g_journal_records = count;
+	free(recs);
+
+	return ret;
+}
@@ -14,141 +14,1130 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <dbus/dbus.h>
+#include <Ecore.h>
 
 #include "minicontrol-error.h"
 #include "minicontrol-internal.h"
 #include "minicontrol-monitor.h"
 #include "minicontrol-log.h"
 
+#define MINICTRL_MONITOR_QUEUE_SIZE_DEFAULT 64
+#define MINICTRL_MONITOR_RATE_DEFAULT 30
+#define MINICTRL_MONITOR_BURST_DEFAULT 60
+
+/* time restored providers have to answer RUNNING_REQ, in seconds */
+#define MINICTRL_MONITOR_RESTORE_GRACE 1.0
+/* records the journal may hold beyond two per provider */
+#define MINICTRL_MONITOR_JOURNAL_SLACK 64
+
+/* updates held back from a throttled provider */
+#define MINICTRL_HELD_RESIZE 0x1
+#define MINICTRL_HELD_PRIORITY 0x2
+
+/* STOP, the pending event itself and PRIORITY */
+#define MINICTRL_MONITOR_EVENT_EXPAND_MAX 3
+
+/* net effect of the events pending for one provider */
+struct _minictrl_monitor_event {
+	const char *name; /* interned */
+	unsigned int name_len;
+	const char *category;
+	minicontrol_action_e action;
+	int stop_first; /* provider was stopped before this START */
+	int known; /* callbacks were told the provider is running */
+	int priority_changed; /* PRIORITY has to follow this RESIZE */
+	unsigned int width;
+	unsigned int height;
+	minicontrol_priority_e priority;
+	unsigned int sequence;
+	unsigned long long timestamp;
+};
+
+/* running provider and the bus connection it was started from */
+struct _minictrl_provider {
+	const char *name; /* interned */
+	const char *sender;
+	const char *category;
+	unsigned int width;
+	unsigned int height;
+	minicontrol_priority_e priority;
+	int restored; /* from the journal, not confirmed by itself yet */
+	double tokens; /* RESIZE and PRIORITY it may send right now */
+	double refilled;
+	int throttled;
+	int held;
+	unsigned long held_count;
+	unsigned int throttle_count;
+};
+
 struct _minicontrol_monitor {
 	minictrl_sig_handle *start_sh;
 	minictrl_sig_handle *stop_sh;
 	minictrl_sig_handle *resize_sh;
+	minictrl_sig_handle *priority_sh;
+	minictrl_sig_handle *batch_sh;
+	minictrl_name_watch *name_watch;
+	Eina_List *providers;
 	minicontrol_monitor_cb callback;
+	minicontrol_monitor_event_cb event_cb;
+	minicontrol_monitor_batch_cb batch_cb;
 	void *user_data;
+	struct _minictrl_monitor_event *queue;
+	unsigned int queue_len;
+	unsigned int queue_size;
+	Ecore_Job *drain_job;
+	Ecore_Timer *rate_timer;
+	Ecore_Timer *restore_timer;
+	unsigned int lost; /* started providers which could not be kept */
 };
 
 static struct _minicontrol_monitor *g_monitor_h;
+static unsigned int g_queue_size = MINICTRL_MONITOR_QUEUE_SIZE_DEFAULT;
+static minicontrol_monitor_queue_stats_s g_queue_stats;
+static unsigned int g_event_sequence;
+static unsigned int g_rate = MINICTRL_MONITOR_RATE_DEFAULT;
+static unsigned int g_burst = MINICTRL_MONITOR_BURST_DEFAULT;
+static minicontrol_monitor_startup_s g_startup;
+static int g_journal_enabled;
+static char g_journal_bus_id[MINICTRL_JOURNAL_BUS_ID_MAX];
+
+/* events of a batch delivered without the queue */
+struct _minictrl_monitor_txn {
+	minicontrol_event_s events[MINICTRL_BATCH_MAX];
+	unsigned int count;
+};
+
+static struct _minictrl_monitor_txn *g_txn;
+
+static unsigned long long _monitor_now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (unsigned long long)ts.tv_sec * 1000000ULL
+		+ ts.tv_nsec / 1000;
+}
+
+/* events are numbered and timed when they reach the monitor */
+static void _monitor_event_stamp(minicontrol_event_s *event)
+{
+	event->sequence = ++g_event_sequence;
+	event->timestamp = _monitor_now_usec();
+}
+
+static void _monitor_deliver(const minicontrol_event_s *events,
+			unsigned int count)
+{
+	const minicontrol_event_s *event;
+	unsigned int i;
+
+	if (!g_monitor_h || !count)
+		return;
+
+	if (g_monitor_h->batch_cb) {
+		g_queue_stats.delivered += count;
+		g_monitor_h->batch_cb(events, count, g_monitor_h->user_data);
+		return;
+	}
+
+	/* callback may stop the monitor */
+	for (i = 0; i < count && g_monitor_h; i++) {
+		event = &events[i];
+
+		if (g_monitor_h->event_cb)
+			g_monitor_h->event_cb(event, g_monitor_h->user_data);
+		else if (event->action == MINICONTROL_ACTION_PRIORITY)
+			/* unknown to callers of the legacy callback */
+			continue;
+		else if (g_monitor_h->callback)
+			g_monitor_h->callback(event->action, event->name,
+					event->width, event->height,
+					event->priority,
+					g_monitor_h->user_data);
+		else
+			return;
+
+		g_queue_stats.delivered++;
+	}
+}
+
+/* turn a pending event into the events the callbacks get to see */
+static unsigned int _monitor_event_expand(
+			const struct _minictrl_monitor_event *ev,
+			minicontrol_event_s *events)
+{
+	minicontrol_event_s *event;
+	unsigned int count = 0;
+
+	if (ev->stop_first) {
+		event = &events[count++];
+		memset(event, 0, sizeof(*event));
+		event->action = MINICONTROL_ACTION_STOP;
+		event->name = ev->name;
+		event->name_len = ev->name_len;
+		event->priority = MINICONTROL_PRIORITY_LOW;
+		event->sequence = ev->sequence;
+		event->timestamp = ev->timestamp;
+	}
+
+	event = &events[count++];
+	event->action = ev->action;
+	event->name = ev->name;
+	event->name_len = ev->name_len;
+	event->category = ev->action == MINICONTROL_ACTION_START ?
+				ev->category : NULL;
+	event->width = ev->width;
+	event->height = ev->height;
+	event->priority = ev->priority;
+	event->sequence = ev->sequence;
+	event->timestamp = ev->timestamp;
+
+	if (ev->priority_changed) {
+		events[count] = *event;
+		events[count].action = MINICONTROL_ACTION_PRIORITY;
+		count++;
+	}
+
+	return count;
+}
+
+static void _monitor_event_free(struct _minictrl_monitor_event *ev)
+{
+	eina_stringshare_del(ev->name);
+	eina_stringshare_del(ev->category);
+}
+
+static void _monitor_queue_flush(void)
+{
+	minicontrol_event_s one[MINICTRL_MONITOR_EVENT_EXPAND_MAX];
+	struct _minictrl_monitor_event *pending;
+	struct _minictrl_monitor_event ev;
+	minicontrol_event_s *events;
+	unsigned int count = 0;
+	unsigned int len;
+	unsigned int i;
+
+	if (!g_monitor_h || !g_monitor_h->queue_len)
+		return;
+
+	len = g_monitor_h->queue_len;
+	pending = malloc(len * (sizeof(*pending) + sizeof(*events)
+				* MINICTRL_MONITOR_EVENT_EXPAND_MAX));
+	if (!pending) {
+		ERR("fail to alloc batch, deliver events one by one");
+		while (g_monitor_h && g_monitor_h->queue_len) {
+			ev = g_monitor_h->queue[0];
+			g_monitor_h->queue_len--;
+			memmove(&g_monitor_h->queue[0], &g_monitor_h->queue[1],
+				sizeof(ev) * g_monitor_h->queue_len);
+
+			_monitor_deliver(one, _monitor_event_expand(&ev, one));
+			_monitor_event_free(&ev);
+		}
+		return;
+	}
+
+	/* take the whole queue, callbacks may push new events */
+	events = (minicontrol_event_s *)(pending + len);
+	memcpy(pending, g_monitor_h->queue, len * sizeof(*pending));
+	g_monitor_h->queue_len = 0;
+
+	for (i = 0; i < len; i++)
+		count += _monitor_event_expand(&pending[i], events + count);
+
+	_monitor_deliver(events, count);
+
+	for (i = 0; i < len; i++)
+		_monitor_event_free(&pending[i]);
+	free(pending);
+}
+
+static void _monitor_queue_drain_cb(void *data)
+{
+	if (!g_monitor_h)
+		return;
+
+	g_monitor_h->drain_job = NULL;
+	_monitor_queue_flush();
+}
 
-static minicontrol_priority_e _int_to_priority(unsigned int value)
+static void _monitor_queue_clear(struct _minicontrol_monitor *monitor_h)
 {
-	minicontrol_priority_e priority = MINICONTROL_PRIORITY_LOW;
-	switch (value) {
-	case MINICONTROL_PRIORITY_TOP:
-		priority = MINICONTROL_PRIORITY_TOP;
+	unsigned int i;
+
+	if (monitor_h->drain_job) {
+		ecore_job_del(monitor_h->drain_job);
+		monitor_h->drain_job = NULL;
+	}
+
+	for (i = 0; i < monitor_h->queue_len; i++)
+		_monitor_event_free(&monitor_h->queue[i]);
+
+	free(monitor_h->queue);
+	monitor_h->queue = NULL;
+	monitor_h->queue_len = 0;
+	monitor_h->queue_size = 0;
+}
+
+/* merge a new event into the one pending for the same provider,
+ * returns 0 if both cancel out and the entry has to be removed */
+static int _monitor_event_merge(struct _minictrl_monitor_event *ev,
+			const minicontrol_event_s *event)
+{
+	const char *category;
+
+	ev->sequence = event->sequence;
+	ev->timestamp = event->timestamp;
+
+	switch (event->action) {
+	case MINICONTROL_ACTION_START:
+		if (ev->action == MINICONTROL_ACTION_STOP)
+			ev->stop_first = 1;
+		ev->action = MINICONTROL_ACTION_START;
+		ev->priority_changed = 0;
+
+		category = eina_stringshare_add(event->category);
+		eina_stringshare_del(ev->category);
+		ev->category = category;
 		break;
-	case MINICONTROL_PRIORITY_MIDDLE:
-		priority = MINICONTROL_PRIORITY_MIDDLE;
+	case MINICONTROL_ACTION_STOP:
+		/* a START nobody has seen yet is undone, a repeated one is not */
+		if (ev->action == MINICONTROL_ACTION_START && !ev->stop_first
+				&& !ev->known)
+			return 0;
+		ev->action = MINICONTROL_ACTION_STOP;
+		ev->stop_first = 0;
+		ev->priority_changed = 0;
 		break;
-	case MINICONTROL_PRIORITY_LOW:
-	default:
-		priority = MINICONTROL_PRIORITY_LOW;
+	case MINICONTROL_ACTION_RESIZE:
+		/* a stopped provider can not be resized */
+		if (ev->action == MINICONTROL_ACTION_STOP)
+			return 1;
+		if (ev->action == MINICONTROL_ACTION_PRIORITY) {
+			ev->action = MINICONTROL_ACTION_RESIZE;
+			ev->priority_changed = 1;
+		}
 		break;
+	case MINICONTROL_ACTION_PRIORITY:
+		if (ev->action == MINICONTROL_ACTION_STOP)
+			return 1;
+		if (ev->action == MINICONTROL_ACTION_RESIZE)
+			ev->priority_changed = 1;
+		/* START and RESIZE already carry the priority */
+		ev->priority = event->priority;
+		return 1;
+	default:
+		return 1;
 	}
-	return priority;
+
+	ev->width = event->width;
+	ev->height = event->height;
+	ev->priority = event->priority;
+
+	return 1;
 }
 
-static void _provider_start_cb(void *data, DBusMessage *msg)
+/* known tells whether the callbacks already know a STARTed provider,
+ * e.g. it answers RUNNING_REQ */
+static void _monitor_event_queue(const minicontrol_event_s *event, int known)
 {
-	DBusError err;
-	char *svr_name = NULL;
-	unsigned int w = 0;
-	unsigned int h = 0;
-	unsigned int pri = 0;
-	minicontrol_priority_e priority;
-	dbus_bool_t dbus_ret;
+	struct _minictrl_monitor_event *ev;
+	unsigned int i;
+
+	if (!g_monitor_h || !event->name)
+		return;
+
+	g_queue_stats.received++;
+
+	/* strings still point into the message, nothing is copied */
+	if (g_txn) {
+		g_txn->events[g_txn->count++] = *event;
+		return;
+	}
+
+	if (!g_monitor_h->queue_size) {
+		_monitor_deliver(event, 1);
+		return;
+	}
 
-	dbus_error_init(&err);
+	for (i = 0; i < g_monitor_h->queue_len; i++) {
+		ev = &g_monitor_h->queue[i];
+		if (ev->name != event->name)
+			continue;
 
-	dbus_ret = dbus_message_get_args(msg, &err,
-				DBUS_TYPE_STRING, &svr_name,
-				DBUS_TYPE_UINT32, &w,
-				DBUS_TYPE_UINT32, &h,
-				DBUS_TYPE_UINT32, &pri,
-				DBUS_TYPE_INVALID);
-	if (!dbus_ret) {
-		ERR("fail to get args : %s", err.message);
-		dbus_error_free(&err);
+		g_queue_stats.coalesced++;
+		if (!_monitor_event_merge(ev, event)) {
+			_monitor_event_free(ev);
+			g_monitor_h->queue_len--;
+			memmove(ev, ev + 1, sizeof(*ev)
+				* (g_monitor_h->queue_len - i));
+		}
 		return;
 	}
 
-	priority = _int_to_priority(pri);
+	if (g_monitor_h->queue_len == g_monitor_h->queue_size) {
+		/* queue is full, deliver what we have right now */
+		g_queue_stats.overflow++;
+		_monitor_queue_flush();
+		if (!g_monitor_h)
+			return;
+	}
+
+	ev = &g_monitor_h->queue[g_monitor_h->queue_len];
+	ev->name = eina_stringshare_ref(event->name);
+	ev->name_len = event->name_len;
+	ev->category = eina_stringshare_add(event->category);
+	ev->action = event->action;
+	ev->stop_first = 0;
+	/* only a provider that runs can be resized */
+	ev->known = event->action != MINICONTROL_ACTION_START || known;
+	ev->priority_changed = 0;
+	ev->width = event->width;
+	ev->height = event->height;
+	ev->priority = event->priority;
+	ev->sequence = event->sequence;
+	ev->timestamp = event->timestamp;
+	g_monitor_h->queue_len++;
 
-	if (g_monitor_h->callback)
-		g_monitor_h->callback(MINICONTROL_ACTION_START,
-				svr_name, w, h, priority,
-				g_monitor_h->user_data);
+	if (g_monitor_h->queue_len > g_queue_stats.high_water)
+		g_queue_stats.high_water = g_monitor_h->queue_len;
 
-	dbus_error_free(&err);
+	if (!g_monitor_h->drain_job)
+		g_monitor_h->drain_job = ecore_job_add(
+					_monitor_queue_drain_cb, NULL);
 }
 
-static void _provider_stop_cb(void *data, DBusMessage *msg)
+static void _monitor_event_push(const minicontrol_event_s *event)
+{
+	_monitor_event_queue(event, 0);
+}
+
+static int _monitor_queue_alloc(struct _minicontrol_monitor *monitor_h,
+				unsigned int size)
+{
+	monitor_h->queue = NULL;
+	monitor_h->queue_len = 0;
+	monitor_h->queue_size = 0;
+	monitor_h->drain_job = NULL;
+
+	if (!size)
+		return MINICONTROL_ERROR_NONE;
+
+	monitor_h->queue = calloc(size, sizeof(struct _minictrl_monitor_event));
+	if (!monitor_h->queue)
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+
+	monitor_h->queue_size = size;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+/* name has to be interned */
+static struct _minictrl_provider *_monitor_provider_find(const char *name)
+{
+	struct _minictrl_provider *provider;
+	Eina_List *l;
+
+	EINA_LIST_FOREACH(g_monitor_h->providers, l, provider) {
+		if (provider->name == name)
+			return provider;
+	}
+
+	return NULL;
+}
+
+static int _monitor_sender_in_use(const char *sender)
+{
+	struct _minictrl_provider *provider;
+	Eina_List *l;
+
+	EINA_LIST_FOREACH(g_monitor_h->providers, l, provider) {
+		if (!strcmp(provider->sender, sender))
+			return 1;
+	}
+
+	return 0;
+}
+
+static void _monitor_provider_free(struct _minictrl_provider *provider)
+{
+	eina_stringshare_del(provider->name);
+	eina_stringshare_del(provider->sender);
+	eina_stringshare_del(provider->category);
+	free(provider);
+}
+
+static void _monitor_journal_entry_fill(minictrl_journal_entry *entry,
+			const struct _minictrl_provider *provider)
+{
+	snprintf(entry->name, sizeof(entry->name), "%s", provider->name);
+	snprintf(entry->sender, sizeof(entry->sender), "%s", provider->sender);
+	snprintf(entry->category, sizeof(entry->category), "%s",
+			provider->category ? provider->category : "");
+	entry->width = provider->width;
+	entry->height = provider->height;
+	entry->priority = provider->priority;
+}
+
+/* replace the records by one per running provider */
+static void _monitor_journal_rewrite(void)
+{
+	struct _minictrl_provider *provider;
+	minictrl_journal_entry *entries;
+	unsigned int count = 0;
+	Eina_List *l;
+
+	entries = malloc((eina_list_count(g_monitor_h->providers) + 1)
+				* sizeof(*entries));
+	if (!entries)
+		return;
+
+	EINA_LIST_FOREACH(g_monitor_h->providers, l, provider)
+		_monitor_journal_entry_fill(&entries[count++], provider);
+
+	_minictrl_journal_rewrite(g_journal_bus_id, entries, count);
+	free(entries);
+}
+
+static void _monitor_journal_update(struct _minictrl_provider *provider)
+{
+	minictrl_journal_entry entry;
+
+	if (!g_journal_enabled)
+		return;
+
+	if (_minictrl_journal_record_count() > MINICTRL_MONITOR_JOURNAL_SLACK
+			+ 2 * eina_list_count(g_monitor_h->providers)) {
+		_monitor_journal_rewrite();
+		return;
+	}
+
+	_monitor_journal_entry_fill(&entry, provider);
+	_minictrl_journal_set(&entry);
+}
+
+static int _monitor_provider_add(const char *name, const char *sender,
+				unsigned int w, unsigned int h,
+				minicontrol_priority_e priority,
+				const char *category)
+{
+	struct _minictrl_provider *provider;
+
+	provider = _monitor_provider_find(name);
+	if (provider) {
+		if (provider->width == w && provider->height == h
+			&& provider->priority == priority)
+			return MINICONTROL_ERROR_NONE;
+
+		provider->width = w;
+		provider->height = h;
+		provider->priority = priority;
+		_monitor_journal_update(provider);
+		return MINICONTROL_ERROR_NONE;
+	}
+
+	if (!sender)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	provider = calloc(1, sizeof(struct _minictrl_provider));
+	if (!provider) {
+		ERR("fail to alloc provider");
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	provider->name = eina_stringshare_ref(name);
+	/* windows of one process share the sender */
+	provider->sender = eina_stringshare_add(sender);
+	provider->category = eina_stringshare_add(category);
+	provider->width = w;
+	provider->height = h;
+	provider->priority = priority;
+	provider->tokens = g_burst;
+	provider->refilled = ecore_time_get();
+	if (!provider->name || !provider->sender) {
+		ERR("fail to alloc provider");
+		_monitor_provider_free(provider);
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	if (!_monitor_sender_in_use(sender))
+		_minictrl_dbus_name_watch_add(g_monitor_h->name_watch, sender);
+
+	g_monitor_h->providers = eina_list_append(g_monitor_h->providers,
+						provider);
+
+	_monitor_journal_update(provider);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+static void _monitor_provider_del(const char *name)
 {
-	DBusError err;
-	char *svr_name = NULL;
-	dbus_bool_t dbus_ret;
+	struct _minictrl_provider *provider;
+
+	provider = _monitor_provider_find(name);
+	if (!provider)
+		return;
+
+	g_monitor_h->providers = eina_list_remove(g_monitor_h->providers,
+						provider);
+	_minictrl_journal_del(provider->name);
+
+	if (!_monitor_sender_in_use(provider->sender))
+		_minictrl_dbus_name_watch_remove(g_monitor_h->name_watch,
+						provider->sender);
+
+	_monitor_provider_free(provider);
+}
 
-	dbus_error_init(&err);
+/* connection of a provider process is gone without sending STOP */
+static void _provider_gone_cb(void *data, const char *sender)
+{
+	struct _minictrl_provider *provider;
+	minicontrol_event_s event;
+	Eina_List *l;
+	Eina_List *l_next;
+	int dropped = 0;
 
-	dbus_ret = dbus_message_get_args(msg, &err,
-				DBUS_TYPE_STRING, &svr_name,
-				DBUS_TYPE_INVALID);
-	if (!dbus_ret) {
-		ERR("fail to get args : %s", err.message);
-		dbus_error_free(&err);
+	if (!g_monitor_h)
 		return;
+
+	EINA_LIST_FOREACH_SAFE(g_monitor_h->providers, l, l_next, provider) {
+		if (strcmp(provider->sender, sender))
+			continue;
+
+		dropped++;
+
+		g_monitor_h->providers = eina_list_remove_list(
+					g_monitor_h->providers, l);
+
+		INFO("provider[%s] is gone", provider->name);
+		_minictrl_journal_del(provider->name);
+		memset(&event, 0, sizeof(event));
+		event.action = MINICONTROL_ACTION_STOP;
+		event.name = provider->name;
+		event.name_len = strlen(provider->name);
+		event.priority = MINICONTROL_PRIORITY_LOW;
+		_monitor_event_stamp(&event);
+		_monitor_event_push(&event);
+		_monitor_provider_free(provider);
+
+		if (!g_monitor_h)
+			return;
+	}
+
+	/* the rule went with the last provider of the sender otherwise */
+	if (dropped)
+		_minictrl_dbus_name_watch_remove(g_monitor_h->name_watch,
+						sender);
+}
+
+/* strings of the event keep pointing into the message */
+static int _monitor_event_decode(DBusMessage *msg,
+			minicontrol_action_e action,
+			minicontrol_event_s *event)
+{
+	if (_minictrl_event_decode(msg, action, event))
+		return -1;
+
+	_monitor_event_stamp(event);
+
+	return 0;
+}
+
+static void _monitor_rate_refill(struct _minictrl_provider *provider,
+				double now)
+{
+	provider->tokens += (now - provider->refilled) * g_rate;
+	if (provider->tokens > g_burst)
+		provider->tokens = g_burst;
+	provider->refilled = now;
+}
+
+static int _monitor_rate_take(struct _minictrl_provider *provider,
+				double now)
+{
+	_monitor_rate_refill(provider, now);
+
+	if (provider->tokens < 1.0)
+		return 0;
+
+	provider->tokens -= 1.0;
+
+	return 1;
+}
+
+/* deliver the latest state instead of the updates held back */
+static void _monitor_rate_release(struct _minictrl_provider *provider)
+{
+	minicontrol_event_s event;
+	int held = provider->held;
+
+	provider->held = 0;
+
+	memset(&event, 0, sizeof(event));
+	event.name = provider->name;
+	event.name_len = strlen(provider->name);
+	event.width = provider->width;
+	event.height = provider->height;
+	event.priority = provider->priority;
+
+	if (held & MINICTRL_HELD_RESIZE) {
+		event.action = MINICONTROL_ACTION_RESIZE;
+		_monitor_event_stamp(&event);
+		_monitor_event_push(&event);
+		if (!g_monitor_h)
+			return;
+	}
+
+	if (held & MINICTRL_HELD_PRIORITY) {
+		event.action = MINICONTROL_ACTION_PRIORITY;
+		_monitor_event_stamp(&event);
+		_monitor_event_push(&event);
+	}
+}
+
+static Eina_Bool _monitor_rate_timer_cb(void *data)
+{
+	struct _minictrl_provider *provider;
+	Eina_List *l;
+	Eina_List *l_next;
+	double now;
+	int busy = 0;
+
+	if (!g_monitor_h)
+		return ECORE_CALLBACK_CANCEL;
+
+	now = ecore_time_get();
+
+	EINA_LIST_FOREACH_SAFE(g_monitor_h->providers, l, l_next, provider) {
+		if (!provider->throttled)
+			continue;
+
+		if (!provider->held) {
+			_monitor_rate_refill(provider, now);
+			if (provider->tokens < g_burst) {
+				busy = 1;
+				continue;
+			}
+
+			provider->throttled = 0;
+			INFO("provider[%s] is not throttled", provider->name);
+			continue;
+		}
+
+		busy = 1;
+		if (!_monitor_rate_take(provider, now))
+			continue;
+
+		_monitor_rate_release(provider);
+
+		/* callback may stop the monitor */
+		if (!g_monitor_h)
+			return ECORE_CALLBACK_CANCEL;
 	}
 
-	if (g_monitor_h->callback)
-		g_monitor_h->callback(MINICONTROL_ACTION_STOP,
-				svr_name, 0, 0, MINICONTROL_PRIORITY_LOW,
-				g_monitor_h->user_data);
+	if (busy)
+		return ECORE_CALLBACK_RENEW;
 
-	dbus_error_free(&err);
+	g_monitor_h->rate_timer = NULL;
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+/* returns 0 if the update is held back from a throttled provider */
+static int _monitor_rate_allow(struct _minictrl_provider *provider,
+				minicontrol_action_e action)
+{
+	if (!g_rate)
+		return 1;
+
+	/* keep the order, nothing passes while updates are held */
+	if (!provider->held && _monitor_rate_take(provider, ecore_time_get()))
+		return 1;
+
+	if (!provider->throttled) {
+		provider->throttled = 1;
+		provider->throttle_count++;
+		INFO("provider[%s] exceeds %u events/s, throttled",
+			provider->name, g_rate);
+	}
+
+	provider->held |= action == MINICONTROL_ACTION_RESIZE ?
+			MINICTRL_HELD_RESIZE : MINICTRL_HELD_PRIORITY;
+	provider->held_count++;
+	g_queue_stats.throttled++;
+
+	if (!g_monitor_h->rate_timer)
+		g_monitor_h->rate_timer = ecore_timer_add(1.0 / g_rate,
+					_monitor_rate_timer_cb, NULL);
+
+	return 0;
+}
+
+static void _monitor_event_handle(minicontrol_event_s *event,
+				const char *sender)
+{
+	struct _minictrl_provider *provider;
+	int known = 0;
+
+	switch (event->action) {
+	case MINICONTROL_ACTION_START:
+		provider = _monitor_provider_find(event->name);
+		known = provider != NULL;
+
+		/* restored from the journal, the callbacks know it already */
+		if (provider && provider->restored) {
+			provider->restored = 0;
+			if (provider->width == event->width
+				&& provider->height == event->height
+				&& provider->priority == event->priority) {
+				DBG("provider[%s] is as restored",
+					event->name);
+				return;
+			}
+		}
+
+		/* its STOP would be taken for one of a provider not running */
+		if (_monitor_provider_add(event->name, sender, event->width,
+				event->height, event->priority,
+				event->category) == MINICONTROL_ERROR_OUT_OF_MEMORY)
+			g_monitor_h->lost++;
+
+		/* START carries the latest state */
+		provider = _monitor_provider_find(event->name);
+		if (provider)
+			provider->held = 0;
+		break;
+	case MINICONTROL_ACTION_STOP:
+		/* every viewer of a provider sends STOP when its plug is gone,
+		 * only the first one for a running provider is of interest */
+		if (!_monitor_provider_find(event->name)) {
+			/* may be the STOP of a provider lost on START */
+			if (g_monitor_h->lost) {
+				g_monitor_h->lost--;
+				DBG("provider[%s] is not known, deliver STOP",
+					event->name);
+				break;
+			}
+			g_queue_stats.stop_suppressed++;
+			DBG("provider[%s] is not running, drop STOP",
+				event->name);
+			return;
+		}
+		_monitor_provider_del(event->name);
+		break;
+	case MINICONTROL_ACTION_RESIZE:
+		provider = _monitor_provider_find(event->name);
+		if (provider) {
+			if (provider->width != event->width
+				|| provider->height != event->height
+				|| provider->priority != event->priority) {
+				provider->width = event->width;
+				provider->height = event->height;
+				provider->priority = event->priority;
+				_monitor_journal_update(provider);
+			}
+
+			if (!_monitor_rate_allow(provider, event->action))
+				return;
+			break;
+		}
+
+		/* without a START there is no rate to hold it to, it
+		 * reports again with START when asked by the monitor */
+		g_queue_stats.unknown_dropped++;
+		DBG("provider[%s] is not running, drop RESIZE", event->name);
+		return;
+	case MINICONTROL_ACTION_PRIORITY:
+		provider = _monitor_provider_find(event->name);
+		if (provider) {
+			if (provider->priority != event->priority) {
+				provider->priority = event->priority;
+				_monitor_journal_update(provider);
+			}
+			event->width = provider->width;
+			event->height = provider->height;
+
+			if (!_monitor_rate_allow(provider, event->action))
+				return;
+			break;
+		}
+
+		g_queue_stats.unknown_dropped++;
+		DBG("provider[%s] is not running, drop PRIORITY", event->name);
+		return;
+	default:
+		return;
+	}
+
+	_monitor_event_queue(event, known);
+}
+
+static void _monitor_signal_handle(DBusMessage *msg,
+				minicontrol_action_e action)
+{
+	minicontrol_event_s event;
+	const char *name;
+
+	if (_monitor_event_decode(msg, action, &event))
+		return;
+
+	/* registry and queue compare interned names by pointer */
+	name = eina_stringshare_add_length(event.name, event.name_len);
+	if (!name)
+		return;
+	event.name = name;
+
+	_monitor_event_handle(&event, dbus_message_get_sender(msg));
+
+	eina_stringshare_del(name);
+}
+
+static void _provider_start_cb(void *data, DBusMessage *msg)
+{
+	_monitor_signal_handle(msg, MINICONTROL_ACTION_START);
+}
+
+static void _provider_stop_cb(void *data, DBusMessage *msg)
+{
+	_monitor_signal_handle(msg, MINICONTROL_ACTION_STOP);
 }
 
 static void _provider_resize_cb(void *data, DBusMessage *msg)
 {
-	DBusError err;
-	char *svr_name = NULL;
-	unsigned int w = 0;
-	unsigned int h = 0;
-	unsigned int pri = 0;
-	minicontrol_priority_e priority;
-	dbus_bool_t dbus_ret;
+	_monitor_signal_handle(msg, MINICONTROL_ACTION_RESIZE);
+}
 
-	dbus_error_init(&err);
+static void _provider_priority_cb(void *data, DBusMessage *msg)
+{
+	_monitor_signal_handle(msg, MINICONTROL_ACTION_PRIORITY);
+}
+
+/* events of several windows of one provider process, e.g. a
+ * transaction, reach the callbacks in one batch */
+static void _provider_batch_cb(void *data, DBusMessage *msg)
+{
+	minicontrol_event_s events[MINICTRL_BATCH_MAX];
+	struct _minictrl_monitor_txn txn;
+	const char *sender;
+	unsigned int count = 0;
+	unsigned int i;
 
-	dbus_ret = dbus_message_get_args(msg, &err,
-				DBUS_TYPE_STRING, &svr_name,
-				DBUS_TYPE_UINT32, &w,
-				DBUS_TYPE_UINT32, &h,
-				DBUS_TYPE_UINT32, &pri,
-				DBUS_TYPE_INVALID);
-	if (!dbus_ret) {
-		ERR("fail to get args : %s", err.message);
-		dbus_error_free(&err);
+	if (_minictrl_event_batch_decode(msg, events,
+				MINICTRL_BATCH_MAX, &count))
 		return;
+
+	if (!g_monitor_h)
+		return;
+
+	/* the queue must not overflow in the middle of the batch */
+	if (g_monitor_h->queue_len + count > g_monitor_h->queue_size) {
+		_monitor_queue_flush();
+		if (!g_monitor_h)
+			return;
 	}
 
-	priority = _int_to_priority(pri);
+	txn.count = 0;
+	if (count > g_monitor_h->queue_size)
+		g_txn = &txn;
 
-	if (g_monitor_h->callback)
-		g_monitor_h->callback(MINICONTROL_ACTION_RESIZE,
-				svr_name, w, h, priority,
-				g_monitor_h->user_data);
+	for (i = 0; i < count; i++)
+		events[i].name = eina_stringshare_add_length(events[i].name,
+							events[i].name_len);
 
-	dbus_error_free(&err);
+	sender = dbus_message_get_sender(msg);
+	for (i = 0; i < count && g_monitor_h; i++) {
+		if (!events[i].name)
+			continue;
+		_monitor_event_stamp(&events[i]);
+		_monitor_event_handle(&events[i], sender);
+	}
+
+	g_txn = NULL;
+	_monitor_deliver(txn.events, txn.count);
+
+	for (i = 0; i < count; i++)
+		eina_stringshare_del(events[i].name);
 }
 
+/* restored providers that did not answer RUNNING_REQ are gone */
+static Eina_Bool _monitor_restore_timer_cb(void *data)
+{
+	struct _minictrl_provider *provider;
+	minicontrol_event_s event;
+	Eina_List *l;
+	Eina_List *l_next;
+
+	if (!g_monitor_h)
+		return ECORE_CALLBACK_CANCEL;
 
-EXPORT_API minicontrol_error_e minicontrol_monitor_start(
-				minicontrol_monitor_cb callback, void *data)
+	g_monitor_h->restore_timer = NULL;
+
+	EINA_LIST_FOREACH_SAFE(g_monitor_h->providers, l, l_next, provider) {
+		if (!provider->restored)
+			continue;
+
+		g_monitor_h->providers = eina_list_remove_list(
+					g_monitor_h->providers, l);
+
+		INFO("restored provider[%s] did not answer", provider->name);
+		_minictrl_journal_del(provider->name);
+		g_startup.journal_dropped++;
+
+		memset(&event, 0, sizeof(event));
+		event.action = MINICONTROL_ACTION_STOP;
+		event.name = provider->name;
+		event.name_len = strlen(provider->name);
+		event.priority = MINICONTROL_PRIORITY_LOW;
+		_monitor_event_stamp(&event);
+		_monitor_event_push(&event);
+
+		if (!_monitor_sender_in_use(provider->sender))
+			_minictrl_dbus_name_watch_remove(
+					g_monitor_h->name_watch,
+					provider->sender);
+		_monitor_provider_free(provider);
+
+		if (!g_monitor_h)
+			return ECORE_CALLBACK_CANCEL;
+	}
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static const minicontrol_state_entry_s *_monitor_state_find(
+			const minicontrol_state_entry_s *states,
+			unsigned int count, const char *name)
 {
-	if (!callback)
-		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		if (!strcmp(states[i].name, name))
+			return &states[i];
+	}
+
+	return NULL;
+}
+
+/* report the providers of the journal still alive without waiting
+ * for them to answer RUNNING_REQ */
+static void _monitor_journal_restore(void)
+{
+	minicontrol_state_entry_s states[MINICTRL_STATE_SLOTS];
+	const minicontrol_state_entry_s *state;
+	struct _minictrl_provider *provider;
+	minictrl_journal_entry *entries = NULL;
+	minicontrol_event_s event;
+	const char **senders;
+	unsigned int state_count = 0;
+	unsigned int count = 0;
+	unsigned int i;
+	int *alive;
+
+	if (_minictrl_dbus_bus_id_get(g_journal_bus_id,
+				sizeof(g_journal_bus_id))
+			!= MINICONTROL_ERROR_NONE)
+		return;
+
+	if (_minictrl_journal_open(g_journal_bus_id, &entries, &count)
+			!= MINICONTROL_ERROR_NONE)
+		return;
+
+	if (!count)
+		return;
+
+	senders = malloc(count * (sizeof(*senders) + sizeof(*alive)));
+	if (!senders) {
+		free(entries);
+		return;
+	}
+	alive = (int *)(senders + count);
+
+	/* unique names are never reused while the bus is up */
+	for (i = 0; i < count; i++)
+		senders[i] = entries[i].sender;
+	if (_minictrl_dbus_names_alive(senders, count, alive)
+			!= MINICONTROL_ERROR_NONE)
+		memset(alive, 0, count * sizeof(*alive));
+
+	_minictrl_state_read(states, MINICTRL_STATE_SLOTS, &state_count);
+
+	for (i = 0; i < count && g_monitor_h; i++) {
+		state = _monitor_state_find(states, state_count,
+					entries[i].name);
+
+		/* a provider stopped while nobody was listening */
+		if (!alive[i] || (state && !state->running)) {
+			g_startup.journal_dropped++;
+			continue;
+		}
+
+		/* the shared table is newer than the journal */
+		if (state) {
+			entries[i].width = state->width;
+			entries[i].height = state->height;
+			entries[i].priority = state->priority;
+		}
+
+		memset(&event, 0, sizeof(event));
+		event.action = MINICONTROL_ACTION_START;
+		event.name = eina_stringshare_add(entries[i].name);
+		if (!event.name)
+			continue;
+		event.name_len = strlen(event.name);
+		event.category = entries[i].category[0] ?
+					entries[i].category : NULL;
+		event.width = entries[i].width;
+		event.height = entries[i].height;
+		event.priority = entries[i].priority;
+
+		_monitor_provider_add(event.name, entries[i].sender,
+				event.width, event.height, event.priority,
+				event.category);
+
+		provider = _monitor_provider_find(event.name);
+		if (provider) {
+			provider->restored = 1;
+			g_startup.journal_restored++;
+
+			_monitor_event_stamp(&event);
+			_monitor_event_push(&event);
+		}
+
+		eina_stringshare_del(event.name);
+	}
+
+	free(senders);
+	free(entries);
+
+	if (!g_monitor_h)
+		return;
+
+	_monitor_journal_rewrite();
+
+	if (g_startup.journal_restored)
+		g_monitor_h->restore_timer = ecore_timer_add(
+				MINICTRL_MONITOR_RESTORE_GRACE,
+				_monitor_restore_timer_cb, NULL);
+}
+
+static minicontrol_error_e _monitor_start(minicontrol_monitor_cb callback,
+				minicontrol_monitor_event_cb event_cb,
+				minicontrol_monitor_batch_cb batch_cb,
+				void *data)
+{
+	unsigned long long begin = _monitor_now_usec();
+	unsigned long long mark = begin;
+	unsigned long long now;
+	int created = 0;
+	int ret;
 
 	if (!g_monitor_h) {
 		minictrl_sig_handle *start_sh;
@@ -156,21 +1145,34 @@ EXPORT_API minicontrol_error_e minicontrol_monitor_start(
 		minictrl_sig_handle *resize_sh;
 		struct _minicontrol_monitor *monitor_h;
 
+		memset(&g_startup, 0, sizeof(g_startup));
+
+		/* handles below share this connection */
+		if (_minictrl_dbus_connect() != MINICONTROL_ERROR_NONE)
+			return MINICONTROL_ERROR_DBUS;
+
+		now = _monitor_now_usec();
+		g_startup.connect_usec = now - mark;
+		mark = now;
+
 		start_sh = _minictrl_dbus_sig_handle_attach(
 				MINICTRL_DBUS_SIG_START,
 				_provider_start_cb, NULL);
 		if (!start_sh) {
 			ERR("fail to _minictrl_dbus_sig_handle_attach - %s",
 				MINICTRL_DBUS_SIG_START);
+			_minictrl_dbus_disconnect();
 			return MINICONTROL_ERROR_DBUS;
 		}
 
 		stop_sh = _minictrl_dbus_sig_handle_attach(
 				MINICTRL_DBUS_SIG_STOP,
 				_provider_stop_cb, NULL);
-		if (!start_sh) {
+		if (!stop_sh) {
 			ERR("fail to _minictrl_dbus_sig_handle_attach - %s",
 				MINICTRL_DBUS_SIG_STOP);
+			_minictrl_dbus_sig_handle_dettach(start_sh);
+			_minictrl_dbus_disconnect();
 			return MINICONTROL_ERROR_DBUS;
 		}
 
@@ -180,6 +1182,9 @@ EXPORT_API minicontrol_error_e minicontrol_monitor_start(
 		if (!resize_sh) {
 			ERR("fail to _minictrl_dbus_sig_handle_attach - %s",
 				MINICTRL_DBUS_SIG_RESIZE);
+			_minictrl_dbus_sig_handle_dettach(start_sh);
+			_minictrl_dbus_sig_handle_dettach(stop_sh);
+			_minictrl_dbus_disconnect();
 			return MINICONTROL_ERROR_DBUS;
 		}
 
@@ -192,21 +1197,126 @@ EXPORT_API minicontrol_error_e minicontrol_monitor_start(
 			return MINICONTROL_ERROR_OUT_OF_MEMORY;
 		}
 
+		monitor_h->rate_timer = NULL;
+		monitor_h->restore_timer = NULL;
+		monitor_h->lost = 0;
+
+		if (_monitor_queue_alloc(monitor_h, g_queue_size)
+						!= MINICONTROL_ERROR_NONE) {
+			ERR("fail to alloc event queue");
+			_minictrl_dbus_sig_handle_dettach(start_sh);
+			_minictrl_dbus_sig_handle_dettach(stop_sh);
+			_minictrl_dbus_sig_handle_dettach(resize_sh);
+			free(monitor_h);
+			return MINICONTROL_ERROR_OUT_OF_MEMORY;
+		}
+
 		monitor_h->start_sh = start_sh;
 		monitor_h->stop_sh = stop_sh;
 		monitor_h->resize_sh = resize_sh;
+		monitor_h->providers = NULL;
+
+		monitor_h->priority_sh = _minictrl_dbus_sig_handle_attach(
+				MINICTRL_DBUS_SIG_PRIORITY,
+				_provider_priority_cb, NULL);
+		if (!monitor_h->priority_sh)
+			WARN("fail to _minictrl_dbus_sig_handle_attach - %s",
+				MINICTRL_DBUS_SIG_PRIORITY);
+
+		monitor_h->batch_sh = _minictrl_dbus_sig_handle_attach(
+				MINICTRL_DBUS_SIG_BATCH,
+				_provider_batch_cb, NULL);
+		if (!monitor_h->batch_sh)
+			WARN("fail to _minictrl_dbus_sig_handle_attach - %s",
+				MINICTRL_DBUS_SIG_BATCH);
+
+		now = _monitor_now_usec();
+		g_startup.match_usec = now - mark;
+		mark = now;
+
+		/* without it crashed providers are only dropped by viewers */
+		monitor_h->name_watch = _minictrl_dbus_name_watch_attach(
+					_provider_gone_cb, NULL);
+		if (!monitor_h->name_watch)
+			WARN("fail to watch provider liveness");
+
+		now = _monitor_now_usec();
+		g_startup.watch_usec = now - mark;
+		mark = now;
+
 		g_monitor_h = monitor_h;
+		created = 1;
 	}
 
 	g_monitor_h->callback = callback;
+	g_monitor_h->event_cb = event_cb;
+	g_monitor_h->batch_cb = batch_cb;
 	g_monitor_h->user_data = data;
-	INFO("callback[%p], data[%p]", callback, data);
+	INFO("callback[%p], event_cb[%p], batch_cb[%p], data[%p]",
+		callback, event_cb, batch_cb, data);
+
+	if (created && g_journal_enabled) {
+		_monitor_journal_restore();
+		if (!g_monitor_h)
+			return MINICONTROL_ERROR_NONE;
+
+		now = _monitor_now_usec();
+		g_startup.journal_usec = now - mark;
+		mark = now;
+	}
+
+	/* also confirms the restored providers */
+	ret = _minictrl_viewer_req_message_send();
 
-	return _minictrl_viewer_req_message_send();
+	if (created) {
+		now = _monitor_now_usec();
+		g_startup.request_usec = now - mark;
+		g_startup.total_usec = now - begin;
+		INFO("started in %llu us : connect[%llu] match[%llu] "
+			"watch[%llu] journal[%llu] request[%llu], "
+			"restored[%u] dropped[%u]", g_startup.total_usec,
+			g_startup.connect_usec, g_startup.match_usec,
+			g_startup.watch_usec, g_startup.journal_usec,
+			g_startup.request_usec, g_startup.journal_restored,
+			g_startup.journal_dropped);
+	}
+
+	return ret;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_start(
+				minicontrol_monitor_cb callback, void *data)
+{
+	if (!callback)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	return _monitor_start(callback, NULL, NULL, data);
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_event_start(
+				minicontrol_monitor_event_cb callback,
+				void *data)
+{
+	if (!callback)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	return _monitor_start(NULL, callback, NULL, data);
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_batch_start(
+				minicontrol_monitor_batch_cb callback,
+				void *data)
+{
+	if (!callback)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	return _monitor_start(NULL, NULL, callback, data);
 }
 
 EXPORT_API minicontrol_error_e minicontrol_monitor_stop(void)
 {
+	struct _minictrl_provider *provider;
+
 	if (!g_monitor_h)
 		return MINICONTROL_ERROR_NONE;
 
@@ -219,9 +1329,223 @@ EXPORT_API minicontrol_error_e minicontrol_monitor_stop(void)
 	if (g_monitor_h->resize_sh)
 		_minictrl_dbus_sig_handle_dettach(g_monitor_h->resize_sh);
 
+	if (g_monitor_h->priority_sh)
+		_minictrl_dbus_sig_handle_dettach(g_monitor_h->priority_sh);
+
+	if (g_monitor_h->batch_sh)
+		_minictrl_dbus_sig_handle_dettach(g_monitor_h->batch_sh);
+
+	_monitor_queue_clear(g_monitor_h);
+
+	if (g_monitor_h->rate_timer)
+		ecore_timer_del(g_monitor_h->rate_timer);
+
+	if (g_monitor_h->restore_timer)
+		ecore_timer_del(g_monitor_h->restore_timer);
+
+	/* the journal stays for the next start */
+	_minictrl_journal_close();
+
+	if (g_monitor_h->name_watch)
+		_minictrl_dbus_name_watch_dettach(g_monitor_h->name_watch);
+
+	EINA_LIST_FREE(g_monitor_h->providers, provider)
+		_monitor_provider_free(provider);
+
 	free(g_monitor_h);
 	g_monitor_h = NULL;
 
 	return MINICONTROL_ERROR_NONE;
 }
 
+EXPORT_API minicontrol_error_e minicontrol_monitor_journal_set(int enable)
+{
+	minictrl_journal_entry *entries = NULL;
+	unsigned int count = 0;
+	int ret;
+
+	if (!enable) {
+		g_journal_enabled = 0;
+		_minictrl_journal_remove();
+		return MINICONTROL_ERROR_NONE;
+	}
+
+	g_journal_enabled = 1;
+
+	if (!g_monitor_h)
+		return MINICONTROL_ERROR_NONE;
+
+	/* running already, the registry is newer than any journal */
+	ret = _minictrl_dbus_bus_id_get(g_journal_bus_id,
+				sizeof(g_journal_bus_id));
+	if (ret != MINICONTROL_ERROR_NONE)
+		return ret;
+
+	ret = _minictrl_journal_open(g_journal_bus_id, &entries, &count);
+	free(entries);
+	if (ret != MINICONTROL_ERROR_NONE)
+		return ret;
+
+	_monitor_journal_rewrite();
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_queue_size_set(
+					unsigned int size)
+{
+	struct _minictrl_monitor_event *queue;
+
+	g_queue_size = size;
+
+	if (!g_monitor_h)
+		return MINICONTROL_ERROR_NONE;
+
+	_monitor_queue_flush();
+	if (!g_monitor_h)
+		return MINICONTROL_ERROR_NONE;
+
+	if (g_monitor_h->drain_job) {
+		ecore_job_del(g_monitor_h->drain_job);
+		g_monitor_h->drain_job = NULL;
+	}
+
+	if (!size) {
+		free(g_monitor_h->queue);
+		g_monitor_h->queue = NULL;
+		g_monitor_h->queue_size = 0;
+		return MINICONTROL_ERROR_NONE;
+	}
+
+	queue = realloc(g_monitor_h->queue,
+			size * sizeof(struct _minictrl_monitor_event));
+	if (!queue)
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+
+	g_monitor_h->queue = queue;
+	g_monitor_h->queue_size = size;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_queue_stats_get(
+				minicontrol_monitor_queue_stats_s *stats)
+{
+	if (!stats)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	*stats = g_queue_stats;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_rate_limit_set(
+				unsigned int rate, unsigned int burst)
+{
+	struct _minictrl_provider *provider;
+	Eina_List *l;
+
+	if (rate && !burst)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	g_rate = rate;
+	g_burst = burst;
+
+	if (!g_monitor_h)
+		return MINICONTROL_ERROR_NONE;
+
+	if (g_monitor_h->rate_timer) {
+		ecore_timer_del(g_monitor_h->rate_timer);
+		g_monitor_h->rate_timer = NULL;
+	}
+
+	EINA_LIST_FOREACH(g_monitor_h->providers, l, provider) {
+		provider->tokens = burst;
+		provider->refilled = ecore_time_get();
+		provider->throttled = 0;
+	}
+
+	/* deliver what is held back right away */
+	EINA_LIST_FOREACH(g_monitor_h->providers, l, provider) {
+		if (!provider->held)
+			continue;
+
+		_monitor_rate_release(provider);
+		if (!g_monitor_h)
+			break;
+	}
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_throttle_get(
+				minicontrol_monitor_throttle_s *entries,
+				unsigned int max, unsigned int *count)
+{
+	struct _minictrl_provider *provider;
+	minicontrol_monitor_throttle_s *entry;
+	Eina_List *l;
+	unsigned int n = 0;
+
+	if (!entries || !count)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	*count = 0;
+
+	if (!g_monitor_h)
+		return MINICONTROL_ERROR_NONE;
+
+	EINA_LIST_FOREACH(g_monitor_h->providers, l, provider) {
+		if (!provider->throttle_count)
+			continue;
+
+		if (n == max)
+			break;
+
+		entry = &entries[n++];
+		snprintf(entry->name, sizeof(entry->name), "%s",
+			provider->name);
+		entry->throttled = provider->throttled;
+		entry->held = provider->held_count;
+		entry->count = provider->throttle_count;
+	}
+
+	*count = n;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_startup_get(
+				minicontrol_monitor_startup_s *startup)
+{
+	if (!startup)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	*startup = g_startup;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_state_get(
+				minicontrol_state_entry_s *entries,
+				unsigned int max, unsigned int *count)
+{
+	return _minictrl_state_read(entries, max, count);
+}
+
+EXPORT_API minicontrol_error_e minicontrol_monitor_resource_get(
+					minicontrol_resource_s *res)
+{
+	if (!res)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	_minictrl_resource_get(res);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API void minicontrol_monitor_resource_dump(void)
+{
+	_minictrl_resource_dump("monitor");
+}
+
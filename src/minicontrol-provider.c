@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 
+#include <unistd.h>
 #include <Elementary.h>
+#include <Ecore_Evas.h>
 
 #include "minicontrol-error.h"
 #include "minicontrol-type.h"
@@ -32,22 +34,305 @@ enum {
 };
 
 struct _provider_data {
-	char *name;
+	const char *name; /* interned */
+	const char *category;
 	int state;
 	minicontrol_priority_e priority;
 	Evas_Object *obj;
 	minictrl_sig_handle *sh;
+	minicontrol_update_policy_e update_policy;
+	double update_interval; /* in seconds */
+	double update_last;
+	Ecore_Timer *update_timer;
+	Ecore_Animator *update_animator;
+	unsigned int update_emitted;
+	unsigned int update_suppressed;
+	double frame_interval; /* 0 if the frame rate is not capped */
+	unsigned int frame_budget; /* pixels per second, 0 if unlimited */
+	double frame_pixels; /* budget left */
+	double frame_last;
+	double frame_refill;
+	int frame_dirty;
+	Ecore_Animator *frame_animator;
+	minicontrol_win_frame_stats_s frame_stats;
 };
 
+/* events of all windows of this process, sent once per main loop */
+struct _provider_batch {
+	minicontrol_event_s events[MINICTRL_BATCH_MAX];
+	unsigned int count;
+	unsigned int depth; /* open transactions, nothing is sent meanwhile */
+	Ecore_Job *job;
+};
+
+static struct _provider_batch g_batch;
+
+static void __batch_event_free(minicontrol_event_s *event)
+{
+	eina_stringshare_del(event->name);
+	eina_stringshare_del(event->category);
+}
+
+static int __batch_flush(void)
+{
+	minicontrol_event_s *event;
+	unsigned int i;
+	int ret;
+
+	if (g_batch.job) {
+		ecore_job_del(g_batch.job);
+		g_batch.job = NULL;
+	}
+
+	if (!g_batch.count)
+		return MINICONTROL_ERROR_NONE;
+
+	/* a single event goes out as the plain signal */
+	event = &g_batch.events[0];
+	if (g_batch.count > 1)
+		ret = _minictrl_provider_batch_message_send(g_batch.events,
+							g_batch.count);
+	else if (event->action == MINICONTROL_ACTION_START)
+		ret = _minictrl_provider_start_message_send(event->name,
+					event->width, event->height,
+					event->priority, event->category);
+	else if (event->action == MINICONTROL_ACTION_PRIORITY)
+		ret = _minictrl_provider_priority_message_send(event->name,
+					event->priority);
+	else
+		ret = _minictrl_provider_message_send(
+					_minictrl_event_sig_name(event->action),
+					event->name, event->width,
+					event->height, event->priority);
+
+	for (i = 0; i < g_batch.count; i++)
+		__batch_event_free(&g_batch.events[i]);
+	g_batch.count = 0;
+
+	return ret;
+}
+
+static void __batch_job_cb(void *data)
+{
+	g_batch.job = NULL;
+
+	if (!g_batch.depth)
+		__batch_flush();
+}
+
+/* name and category have to be interned */
+static int __batch_add(minicontrol_action_e action, const char *name,
+			unsigned int w, unsigned int h,
+			minicontrol_priority_e priority,
+			const char *category)
+{
+	minicontrol_event_s *event;
+	int i;
+
+	/* only the latest size or priority of a window matters */
+	for (i = (int)g_batch.count - 1; i >= 0; i--) {
+		event = &g_batch.events[i];
+		if (event->name != name)
+			continue;
+
+		if (event->action == action
+			&& (action == MINICONTROL_ACTION_RESIZE
+				|| action == MINICONTROL_ACTION_PRIORITY)) {
+			event->width = w;
+			event->height = h;
+			event->priority = priority;
+			return MINICONTROL_ERROR_NONE;
+		}
+		break;
+	}
+
+	if (g_batch.count == MINICTRL_BATCH_MAX) {
+		if (g_batch.depth)
+			WARN("transaction exceeds %d changes, it is split",
+					MINICTRL_BATCH_MAX);
+		__batch_flush();
+	}
+
+	event = &g_batch.events[g_batch.count];
+	memset(event, 0, sizeof(*event));
+	event->action = action;
+	event->name = eina_stringshare_ref(name);
+	event->category = eina_stringshare_ref(category);
+	if (!event->name) {
+		ERR("fail to alloc batch event");
+		__batch_event_free(event);
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+	event->name_len = strlen(name);
+	event->width = w;
+	event->height = h;
+	event->priority = priority;
+	g_batch.count++;
+
+	if (g_batch.depth)
+		return MINICONTROL_ERROR_NONE;
+
+	/* the window may be gone before the main loop runs again */
+	if (action == MINICONTROL_ACTION_STOP)
+		return __batch_flush();
+
+	if (!g_batch.job)
+		g_batch.job = ecore_job_add(__batch_job_cb, NULL);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+static void __provider_resize_cancel(struct _provider_data *pd)
+{
+	if (pd->update_timer) {
+		ecore_timer_del(pd->update_timer);
+		pd->update_timer = NULL;
+	}
+
+	if (pd->update_animator) {
+		ecore_animator_del(pd->update_animator);
+		pd->update_animator = NULL;
+	}
+}
+
+static void __provider_frame_render_set(struct _provider_data *pd,
+					int manual)
+{
+	Ecore_Evas *ee;
+
+	ee = ecore_evas_ecore_evas_get(evas_object_evas_get(pd->obj));
+	if (ee && ecore_evas_manual_render_get(ee) != !!manual)
+		ecore_evas_manual_render_set(ee, manual);
+}
+
+static void __provider_frame_animator_stop(struct _provider_data *pd)
+{
+	if (pd->frame_animator) {
+		ecore_animator_del(pd->frame_animator);
+		pd->frame_animator = NULL;
+	}
+
+	/* the next change is rendered on idle and starts the animator */
+	__provider_frame_render_set(pd, 0);
+}
+
+static Eina_Bool __provider_frame_animator_cb(void *data)
+{
+	struct _provider_data *pd = data;
+	Ecore_Evas *ee;
+	Evas_Coord w = 0;
+	Evas_Coord h = 0;
+	double now = ecore_loop_time_get();
+	double need;
+
+	if (pd->frame_budget) {
+		pd->frame_pixels += (now - pd->frame_refill) * pd->frame_budget;
+		if (pd->frame_pixels > pd->frame_budget)
+			pd->frame_pixels = pd->frame_budget;
+		pd->frame_refill = now;
+	}
+
+	/* ticks are not exact, half a tick early is still on time */
+	if (now - pd->frame_last < pd->frame_interval
+				- ecore_animator_frametime_get() / 2) {
+		if (pd->frame_dirty)
+			pd->frame_stats.throttled++;
+		return ECORE_CALLBACK_RENEW;
+	}
+
+	if (pd->frame_budget) {
+		evas_object_geometry_get(pd->obj, NULL, NULL, &w, &h);
+		need = (double)w * h;
+		if (need > pd->frame_budget)
+			need = pd->frame_budget;
+
+		if (pd->frame_pixels < need) {
+			if (pd->frame_dirty)
+				pd->frame_stats.over_budget++;
+			return ECORE_CALLBACK_RENEW;
+		}
+	}
+
+	/* the last tick rendered nothing and a frame is allowed now,
+	 * so rendering on idle again does not break the limit */
+	if (!pd->frame_dirty) {
+		pd->frame_animator = NULL;
+		__provider_frame_render_set(pd, 0);
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	ee = ecore_evas_ecore_evas_get(evas_object_evas_get(pd->obj));
+	if (!ee)
+		return ECORE_CALLBACK_RENEW;
+
+	/* set again by the flush if the frame had anything to draw */
+	pd->frame_dirty = 0;
+	ecore_evas_manual_render(ee);
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+static void __provider_frame_flush_cb(void *data, Evas *e, void *event_info)
+{
+	struct _provider_data *pd = data;
+	Evas_Coord w = 0;
+	Evas_Coord h = 0;
+
+	pd->frame_stats.rendered++;
+	pd->frame_dirty = 1;
+	pd->frame_last = ecore_loop_time_get();
+
+	/* damage is not known here, charge the whole window */
+	if (pd->frame_budget) {
+		evas_object_geometry_get(pd->obj, NULL, NULL, &w, &h);
+		pd->frame_pixels -= (double)w * h;
+	}
+
+	if (pd->frame_animator || pd->state != MINICTRL_STATE_RUNNING
+		|| (pd->frame_interval <= 0.0 && !pd->frame_budget))
+		return;
+
+	/* hold back the following frames until the limit allows them */
+	__provider_frame_render_set(pd, 1);
+	pd->frame_animator = ecore_animator_add(
+				__provider_frame_animator_cb, pd);
+}
+
+/* while limited and running a frame rendered on idle starts the animator,
+ * it renders the following ones and stops once there is nothing to draw */
+static void __provider_frame_limit_apply(struct _provider_data *pd)
+{
+	int limited = pd->frame_interval > 0.0 || pd->frame_budget;
+
+	if (limited && pd->state == MINICTRL_STATE_RUNNING)
+		return;
+
+	__provider_frame_animator_stop(pd);
+}
+
 static void __provider_data_free(struct _provider_data *pd)
 {
 	if (pd) {
-		if (pd->name)
-			free(pd->name);
+		_minictrl_resource_del(MINICTRL_RESOURCE_PROVIDER,
+				sizeof(struct _provider_data)
+				+ (pd->name ? strlen(pd->name) + 1 : 0)
+				+ (pd->category ? strlen(pd->category) + 1 : 0));
+
+		eina_stringshare_del(pd->name);
+		eina_stringshare_del(pd->category);
 
 		if (pd->sh)
 			_minictrl_dbus_sig_handle_dettach(pd->sh);
 
+		__provider_resize_cancel(pd);
+
+		if (pd->frame_animator)
+			ecore_animator_del(pd->frame_animator);
+
+		evas_event_callback_del_full(evas_object_evas_get(pd->obj),
+				EVAS_CALLBACK_RENDER_FLUSH_POST,
+				__provider_frame_flush_cb, pd);
+
 		free(pd);
 	}
 }
@@ -72,6 +357,31 @@ static int __str_has_suffix(const char *str, const char *suffix)
 	return strcmp(str + str_len - suffix_len, suffix);
 }
 
+static void __provider_state_publish(struct _provider_data *pd)
+{
+	Evas_Coord w = 0;
+	Evas_Coord h = 0;
+
+	evas_object_geometry_get(pd->obj, NULL, NULL, &w, &h);
+
+	_minictrl_state_publish(pd->name,
+			pd->state == MINICTRL_STATE_RUNNING ?
+				MINICTRL_SHARED_STATE_RUNNING :
+				MINICTRL_SHARED_STATE_READY,
+			w, h, pd->priority);
+}
+
+static int __provider_start_send(struct _provider_data *pd)
+{
+	Evas_Coord w = 0;
+	Evas_Coord h = 0;
+
+	evas_object_geometry_get(pd->obj, NULL, NULL, &w, &h);
+
+	return __batch_add(MINICONTROL_ACTION_START, pd->name, w, h,
+				pd->priority, pd->category);
+}
+
 static void _running_req_cb(void *data, DBusMessage *msg)
 {
 	struct _provider_data *pd;
@@ -82,13 +392,8 @@ static void _running_req_cb(void *data, DBusMessage *msg)
 	}
 	pd = data;
 
-	if (pd->state == MINICTRL_STATE_RUNNING) {
-		Evas_Coord w = 0;
-		Evas_Coord h = 0;
-		evas_object_geometry_get(pd->obj, NULL, NULL, &w, &h);
-		_minictrl_provider_message_send(MINICTRL_DBUS_SIG_START,
-					pd->name, w, h, pd->priority);
-	}
+	if (pd->state == MINICTRL_STATE_RUNNING)
+		__provider_start_send(pd);
 }
 
 static int minicontrol_win_start(Evas_Object *mincontrol)
@@ -113,13 +418,20 @@ static int minicontrol_win_start(Evas_Object *mincontrol)
 	}
 
 	if (pd->state != MINICTRL_STATE_RUNNING) {
-		Evas_Coord w = 0;
-		Evas_Coord h = 0;
 		pd->state = MINICTRL_STATE_RUNNING;
 
-		evas_object_geometry_get(mincontrol, NULL, NULL, &w, &h);
-		ret = _minictrl_provider_message_send(MINICTRL_DBUS_SIG_START,
-					pd->name, w, h, pd->priority);
+		/* START carries the current size */
+		__provider_resize_cancel(pd);
+
+		/* listen to monitors only while there is something to answer */
+		if (!pd->sh)
+			pd->sh = _minictrl_dbus_sig_handle_attach(
+					MINICTRL_DBUS_SIG_RUNNING_REQ,
+					_running_req_cb, pd);
+
+		ret = __provider_start_send(pd);
+		__provider_state_publish(pd);
+		__provider_frame_limit_apply(pd);
 	}
 
 	return ret;
@@ -147,8 +459,17 @@ static int minicontrol_win_stop(Evas_Object *mincontrol)
 	}
 	if (pd->state != MINICTRL_STATE_READY) {
 		pd->state = MINICTRL_STATE_READY;
-		ret = _minictrl_provider_message_send(MINICTRL_DBUS_SIG_STOP,
-					pd->name, 0, 0, pd->priority);
+		__provider_resize_cancel(pd);
+
+		if (pd->sh) {
+			_minictrl_dbus_sig_handle_dettach(pd->sh);
+			pd->sh = NULL;
+		}
+
+		ret = __batch_add(MINICONTROL_ACTION_STOP,
+				pd->name, 0, 0, pd->priority, NULL);
+		__provider_state_publish(pd);
+		__provider_frame_limit_apply(pd);
 	}
 
 	return ret;
@@ -162,6 +483,8 @@ static void _minictrl_win_del(void *data, Evas *e,
 	minicontrol_win_stop(obj);
 
 	pd = evas_object_data_get(obj, MINICTRL_DATA_KEY);
+	if (pd)
+		_minictrl_state_remove(pd->name);
 	__provider_data_free(pd);
 
 	evas_object_data_set(obj, MINICTRL_DATA_KEY, NULL);
@@ -179,10 +502,49 @@ static void _minictrl_win_show(void *data, Evas *e,
 	minicontrol_win_start(obj);
 }
 
+static void __provider_resize_send(struct _provider_data *pd)
+{
+	Evas_Coord w = 0;
+	Evas_Coord h = 0;
+
+	if (pd->state != MINICTRL_STATE_RUNNING)
+		return;
+
+	evas_object_geometry_get(pd->obj, NULL, NULL, &w, &h);
+	__batch_add(MINICONTROL_ACTION_RESIZE,
+			pd->name, w, h, pd->priority, NULL);
+
+	__provider_state_publish(pd);
+
+	pd->update_last = ecore_loop_time_get();
+	pd->update_emitted++;
+}
+
+static Eina_Bool __provider_resize_timer_cb(void *data)
+{
+	struct _provider_data *pd = data;
+
+	pd->update_timer = NULL;
+	__provider_resize_send(pd);
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool __provider_resize_animator_cb(void *data)
+{
+	struct _provider_data *pd = data;
+
+	pd->update_animator = NULL;
+	__provider_resize_send(pd);
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
 static void _minictrl_win_resize(void *data, Evas *e,
 			Evas_Object *obj, void *event_info)
 {
 	struct _provider_data *pd;
+	double elapsed;
 
 	if (!data) {
 		ERR("data is NULL, invaild parameter");
@@ -190,43 +552,61 @@ static void _minictrl_win_resize(void *data, Evas *e,
 	}
 	pd = data;
 
-	if (pd->state == MINICTRL_STATE_RUNNING) {
-		Evas_Coord w = 0;
-		Evas_Coord h = 0;
+	if (pd->state != MINICTRL_STATE_RUNNING)
+		return;
+
+	/* a pending update will pick up the latest size */
+	if (pd->update_timer || pd->update_animator) {
+		pd->update_suppressed++;
+		if (pd->update_policy == MINICONTROL_UPDATE_POLICY_FINAL)
+			ecore_timer_reset(pd->update_timer);
+		return;
+	}
 
-		evas_object_geometry_get(obj, NULL, NULL, &w, &h);
-		_minictrl_provider_message_send(MINICTRL_DBUS_SIG_RESIZE,
-					pd->name, w, h, pd->priority);
+	switch (pd->update_policy) {
+	case MINICONTROL_UPDATE_POLICY_PER_FRAME:
+		pd->update_animator = ecore_animator_add(
+				__provider_resize_animator_cb, pd);
+		break;
+	case MINICONTROL_UPDATE_POLICY_DEBOUNCE:
+		elapsed = ecore_loop_time_get() - pd->update_last;
+		if (elapsed >= pd->update_interval) {
+			__provider_resize_send(pd);
+			return;
+		}
+		pd->update_timer = ecore_timer_add(
+				pd->update_interval - elapsed,
+				__provider_resize_timer_cb, pd);
+		break;
+	case MINICONTROL_UPDATE_POLICY_FINAL:
+		pd->update_timer = ecore_timer_add(pd->update_interval,
+				__provider_resize_timer_cb, pd);
+		break;
+	case MINICONTROL_UPDATE_POLICY_IMMEDIATE:
+	default:
+		__provider_resize_send(pd);
+		return;
 	}
+
+	if (!pd->update_timer && !pd->update_animator)
+		__provider_resize_send(pd);
 }
 
-static char *_minictrl_create_name(const char *name)
+static const char *_minictrl_create_name(const char *name)
 {
-	time_t now;
-	struct tm *now_tm;
-	char time_buf[20]; /* 18 chars to represent time */
-	char *buf;
-	int size = 0;
+	static unsigned int serial;
+	unsigned int id;
 
 	if (!name) {
 		ERR("name is NULL, invaild parameter");
 		return NULL;
 	}
 
-	now = time(NULL);
-	now_tm = localtime(&now);
-	strftime(time_buf, sizeof(time_buf), "%y-%m-%d-%H:%M:%S", now_tm);
-
-	size = snprintf(NULL, 0, "[%s]-[%s]", name, time_buf) + 1;
-	buf = (char *)malloc(sizeof(char) * size);
-	if (!buf) {
-	       ERR("fail to alloc buf");
-	       return NULL;
-	}
-
-	snprintf(buf, size, "[%s]-[%s]", name, time_buf);
+	/* pid + per-process serial is unique across rapid creation
+	 * and needs neither localtime() nor a timezone lookup */
+	id = __sync_add_and_fetch(&serial, 1);
 
-	return buf;
+	return eina_stringshare_printf("[%s]-[%d-%u]", name, getpid(), id);
 }
 
 static minicontrol_priority_e _minictrl_get_priroty_by_name(const char *name)
@@ -241,23 +621,52 @@ static minicontrol_priority_e _minictrl_get_priroty_by_name(const char *name)
 	return priority;
 }
 
-EXPORT_API Evas_Object *minicontrol_win_add(const char *name)
+static int __update_policy_valid(minicontrol_update_policy_e policy,
+				unsigned int interval_ms)
+{
+	switch (policy) {
+	case MINICONTROL_UPDATE_POLICY_IMMEDIATE:
+	case MINICONTROL_UPDATE_POLICY_PER_FRAME:
+		return 1;
+	case MINICONTROL_UPDATE_POLICY_DEBOUNCE:
+	case MINICONTROL_UPDATE_POLICY_FINAL:
+		if (!interval_ms) {
+			ERR("interval is 0, invaild parameter");
+			return 0;
+		}
+		return 1;
+	default:
+		ERR("unknown policy[%d], invaild parameter", policy);
+		return 0;
+	}
+}
+
+EXPORT_API Evas_Object *minicontrol_win_add_with_info(
+				const minicontrol_win_info_s *info)
 {
 	Evas_Object *win = NULL;
-	char *name_inter = NULL;
+	const char *name_inter = NULL;
 	struct _provider_data *pd;
 
-	if (!name)
+	if (!info || !info->name)
+		return NULL;
+
+	if (info->priority && !_minictrl_priority_valid(info->priority)) {
+		ERR("unknown priority[%d], invaild parameter", info->priority);
+		return NULL;
+	}
+
+	if (!__update_policy_valid(info->update_policy, info->update_interval))
 		return NULL;
 
 	win = elm_win_add(NULL, "minicontrol", ELM_WIN_SOCKET_IMAGE);
 	if (!win)
 		return NULL;
 
-	name_inter = _minictrl_create_name(name);
+	name_inter = _minictrl_create_name(info->name);
 	if (!name_inter) {
 
-		ERR("Fail to create name_inter for : %s", name);
+		ERR("Fail to create name_inter for : %s", info->name);
 		evas_object_del(win);
 		return NULL;
 
@@ -266,6 +675,7 @@ EXPORT_API Evas_Object *minicontrol_win_add(const char *name)
 	if (!elm_win_socket_listen(win, name_inter, 0, EINA_FALSE)) {
 		ERR("Fail to elm win socket listen");
 		evas_object_del(win);
+		eina_stringshare_del(name_inter);
 		return NULL;
 	}
 
@@ -273,7 +683,7 @@ EXPORT_API Evas_Object *minicontrol_win_add(const char *name)
 	if (!pd) {
 		ERR("Fail to alloc memory");
 		evas_object_del(win);
-		free(name_inter);
+		eina_stringshare_del(name_inter);
 		return NULL;
 
 	}
@@ -281,7 +691,18 @@ EXPORT_API Evas_Object *minicontrol_win_add(const char *name)
 	pd->name = name_inter;
 	pd->state = MINICTRL_STATE_READY;
 	pd->obj = win;
-	pd->priority = _minictrl_get_priroty_by_name(name);
+
+	if (info->priority)
+		pd->priority = info->priority;
+	else
+		pd->priority = _minictrl_get_priroty_by_name(info->name);
+
+	if (info->category)
+		pd->category = eina_stringshare_add(info->category);
+
+	_minictrl_resource_add(MINICTRL_RESOURCE_PROVIDER,
+			sizeof(struct _provider_data) + strlen(name_inter) + 1
+			+ (pd->category ? strlen(pd->category) + 1 : 0));
 
 	evas_object_data_set(win ,MINICTRL_DATA_KEY,pd);
 
@@ -299,8 +720,28 @@ EXPORT_API Evas_Object *minicontrol_win_add(const char *name)
 	evas_object_event_callback_add(win, EVAS_CALLBACK_RESIZE,
 					_minictrl_win_resize, pd);
 
-	pd->sh = _minictrl_dbus_sig_handle_attach(MINICTRL_DBUS_SIG_RUNNING_REQ,
-					_running_req_cb, pd);
+	evas_event_callback_add(evas_object_evas_get(win),
+					EVAS_CALLBACK_RENDER_FLUSH_POST,
+					__provider_frame_flush_cb, pd);
+
+	if (info->width > 0 && info->height > 0)
+		evas_object_resize(win, info->width, info->height);
+
+	if (info->update_policy != MINICONTROL_UPDATE_POLICY_IMMEDIATE
+		&& minicontrol_win_update_policy_set(win, info->update_policy,
+			info->update_interval) != MINICONTROL_ERROR_NONE) {
+		ERR("fail to set update policy");
+		evas_object_del(win);
+		return NULL;
+	}
+
+	if ((info->max_fps || info->pixel_budget)
+		&& minicontrol_win_frame_limit_set(win, info->max_fps,
+			info->pixel_budget) != MINICONTROL_ERROR_NONE) {
+		ERR("fail to set frame limit");
+		evas_object_del(win);
+		return NULL;
+	}
 
 	INFO("new minicontrol win[%p] created - %s, priority[%d]",
 				win, pd->name, pd->priority);
@@ -308,3 +749,198 @@ EXPORT_API Evas_Object *minicontrol_win_add(const char *name)
 	return win;
 }
 
+EXPORT_API Evas_Object *minicontrol_win_add(const char *name)
+{
+	minicontrol_win_info_s info;
+
+	memset(&info, 0x00, sizeof(minicontrol_win_info_s));
+	info.name = name;
+
+	return minicontrol_win_add_with_info(&info);
+}
+
+EXPORT_API minicontrol_error_e minicontrol_win_priority_set(
+				Evas_Object *minicontrol,
+				minicontrol_priority_e priority)
+{
+	struct _provider_data *pd;
+
+	if (!minicontrol) {
+		ERR("minicontrol is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	pd = evas_object_data_get(minicontrol, MINICTRL_DATA_KEY);
+	if (!pd) {
+		ERR("pd is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	if (!_minictrl_priority_valid(priority)) {
+		ERR("unknown priority[%d], invaild parameter", priority);
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	if (pd->priority == priority)
+		return MINICONTROL_ERROR_NONE;
+
+	pd->priority = priority;
+
+	if (pd->state != MINICTRL_STATE_RUNNING)
+		return MINICONTROL_ERROR_NONE;
+
+	__provider_state_publish(pd);
+
+	return __batch_add(MINICONTROL_ACTION_PRIORITY,
+				pd->name, 0, 0, pd->priority, NULL);
+}
+
+EXPORT_API minicontrol_error_e minicontrol_win_update_policy_set(
+				Evas_Object *minicontrol,
+				minicontrol_update_policy_e policy,
+				unsigned int interval_ms)
+{
+	struct _provider_data *pd;
+
+	if (!minicontrol) {
+		ERR("minicontrol is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	pd = evas_object_data_get(minicontrol, MINICTRL_DATA_KEY);
+	if (!pd) {
+		ERR("pd is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	if (!__update_policy_valid(policy, interval_ms))
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	/* deliver what is pending under the old policy */
+	if (pd->update_timer || pd->update_animator) {
+		__provider_resize_cancel(pd);
+		__provider_resize_send(pd);
+	}
+
+	pd->update_policy = policy;
+	pd->update_interval = interval_ms / 1000.0;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_win_update_stats_get(
+				Evas_Object *minicontrol,
+				unsigned int *emitted,
+				unsigned int *suppressed)
+{
+	struct _provider_data *pd;
+
+	if (!minicontrol) {
+		ERR("minicontrol is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	pd = evas_object_data_get(minicontrol, MINICTRL_DATA_KEY);
+	if (!pd) {
+		ERR("pd is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	if (emitted)
+		*emitted = pd->update_emitted;
+
+	if (suppressed)
+		*suppressed = pd->update_suppressed;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_win_frame_limit_set(
+				Evas_Object *minicontrol,
+				unsigned int max_fps,
+				unsigned int pixel_budget)
+{
+	struct _provider_data *pd;
+
+	if (!minicontrol) {
+		ERR("minicontrol is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	pd = evas_object_data_get(minicontrol, MINICTRL_DATA_KEY);
+	if (!pd) {
+		ERR("pd is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	pd->frame_interval = max_fps ? 1.0 / max_fps : 0.0;
+	pd->frame_budget = pixel_budget;
+	if (pd->frame_pixels > pixel_budget)
+		pd->frame_pixels = pixel_budget;
+
+	__provider_frame_limit_apply(pd);
+
+	INFO("minicontrol win[%p] frame limit %u fps, %u pixels/s",
+				minicontrol, max_fps, pixel_budget);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_win_frame_stats_get(
+				Evas_Object *minicontrol,
+				minicontrol_win_frame_stats_s *stats)
+{
+	struct _provider_data *pd;
+
+	if (!minicontrol || !stats) {
+		ERR("invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	pd = evas_object_data_get(minicontrol, MINICTRL_DATA_KEY);
+	if (!pd) {
+		ERR("pd is NULL, invaild parameter");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	*stats = pd->frame_stats;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_win_transaction_begin(void)
+{
+	g_batch.depth++;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_win_transaction_commit(void)
+{
+	if (!g_batch.depth) {
+		ERR("no transaction to commit");
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+	}
+
+	if (--g_batch.depth)
+		return MINICONTROL_ERROR_NONE;
+
+	return __batch_flush();
+}
+
+EXPORT_API minicontrol_error_e minicontrol_provider_resource_get(
+					minicontrol_resource_s *res)
+{
+	if (!res)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	_minictrl_resource_get(res);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API void minicontrol_provider_resource_dump(void)
+{
+	_minictrl_resource_dump("provider");
+}
+
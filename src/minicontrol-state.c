@@ -0,0 +1,442 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "minicontrol-error.h"
+#include "minicontrol-internal.h"
+#include "minicontrol-log.h"
+
+#define MINICTRL_STATE_FILE "state"
+#define MINICTRL_STATE_MAGIC 0x5453434d /* "MCST" */
+#define MINICTRL_STATE_VERSION 2
+#define MINICTRL_STATE_READ_RETRY 16
+
+/*
+ * Table shared by the processes of one user through a memory mapped file
+ * in the private runtime directory. Each slot is protected by its own
+ * sequence lock: writers take the slot by a compare-and-swap of lock from
+ * 0 to their pid, make seq odd, update the slot, make seq even again and
+ * clear lock. Readers retry while seq is odd or changed during the copy.
+ * A slot locked by a process that died is taken over by the next writer.
+ */
+struct _minictrl_state_slot {
+	uint32_t seq;
+	int32_t lock; /* pid of the writer holding the slot, 0 if free */
+	uint32_t state;
+	int32_t pid;
+	uint32_t width;
+	uint32_t height;
+	uint32_t priority;
+	uint32_t reserved;
+	uint64_t updated;
+	char name[MINICONTROL_STATE_NAME_MAX];
+};
+
+struct _minictrl_state_table {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slot_count;
+	uint32_t reserved;
+	struct _minictrl_state_slot slots[MINICTRL_STATE_SLOTS];
+};
+
+static struct _minictrl_state_table *g_state_table;
+/* read only mapping of processes which never published */
+static const struct _minictrl_state_table *g_state_table_ro;
+
+static int __state_table_valid(const struct _minictrl_state_table *table)
+{
+	if (table->magic != MINICTRL_STATE_MAGIC
+		|| table->version != MINICTRL_STATE_VERSION
+		|| table->slot_count != MINICTRL_STATE_SLOTS) {
+		ERR("%s has unknown format", MINICTRL_STATE_FILE);
+		return 0;
+	}
+
+	return 1;
+}
+
+/* the table is created by the first provider which publishes */
+static struct _minictrl_state_table *__state_table_get(void)
+{
+	struct _minictrl_state_table *table;
+	struct stat st;
+	int fd;
+
+	if (g_state_table)
+		return g_state_table;
+
+	fd = _minictrl_runtime_open(MINICTRL_STATE_FILE, O_RDWR | O_CREAT,
+					0600);
+	if (fd < 0) {
+		ERR("fail to open %s", MINICTRL_STATE_FILE);
+		return NULL;
+	}
+
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return NULL;
+	}
+
+	if (st.st_size < (off_t)sizeof(struct _minictrl_state_table)
+		&& ftruncate(fd, sizeof(struct _minictrl_state_table))) {
+		close(fd);
+		return NULL;
+	}
+
+	table = mmap(NULL, sizeof(struct _minictrl_state_table),
+			PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (table == MAP_FAILED) {
+		ERR("fail to map %s", MINICTRL_STATE_FILE);
+		return NULL;
+	}
+
+	/* a new file is all zero, the first process stamps it */
+	if (__sync_bool_compare_and_swap(&table->magic, 0,
+					MINICTRL_STATE_MAGIC)) {
+		table->version = MINICTRL_STATE_VERSION;
+		table->slot_count = MINICTRL_STATE_SLOTS;
+	}
+
+	if (!__state_table_valid(table)) {
+		munmap(table, sizeof(struct _minictrl_state_table));
+		return NULL;
+	}
+
+	g_state_table = table;
+
+	return table;
+}
+
+/* readers never create, stamp or write the table */
+static const struct _minictrl_state_table *__state_table_read_get(void)
+{
+	const struct _minictrl_state_table *table;
+	struct stat st;
+	int fd;
+
+	if (g_state_table)
+		return g_state_table;
+
+	if (g_state_table_ro)
+		return g_state_table_ro;
+
+	fd = _minictrl_runtime_open(MINICTRL_STATE_FILE, O_RDONLY, 0);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st) < 0
+		|| st.st_size < (off_t)sizeof(struct _minictrl_state_table)) {
+		close(fd);
+		return NULL;
+	}
+
+	table = mmap(NULL, sizeof(struct _minictrl_state_table),
+			PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (table == MAP_FAILED) {
+		ERR("fail to map %s", MINICTRL_STATE_FILE);
+		return NULL;
+	}
+
+	/* not stamped yet by its creator, look again next time */
+	if (!__atomic_load_n(&table->magic, __ATOMIC_ACQUIRE)
+		|| !__state_table_valid(table)) {
+		munmap((void *)table, sizeof(struct _minictrl_state_table));
+		return NULL;
+	}
+
+	g_state_table_ro = table;
+
+	return table;
+}
+
+static int __pid_is_alive(pid_t pid)
+{
+	if (pid <= 0)
+		return 0;
+
+	return !(kill(pid, 0) < 0 && errno == ESRCH);
+}
+
+static uint64_t __now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int __slot_lock(struct _minictrl_state_slot *slot)
+{
+	int32_t pid = getpid();
+	int32_t owner = __atomic_load_n(&slot->lock, __ATOMIC_ACQUIRE);
+
+	/* slots are never held across calls, our own pid is left over
+	 * from a dead process the pid was reused from */
+	if (owner && owner != pid && __pid_is_alive(owner))
+		return 0;
+
+	if (!__sync_bool_compare_and_swap(&slot->lock, owner, pid))
+		return 0;
+
+	if (owner)
+		WARN("take over slot locked by dead pid[%d]", owner);
+
+	/* seq is still odd if the writer died in the middle */
+	if (!(__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) & 1))
+		__atomic_add_fetch(&slot->seq, 1, __ATOMIC_ACQ_REL);
+
+	return 1;
+}
+
+static void __slot_unlock(struct _minictrl_state_slot *slot)
+{
+	__atomic_add_fetch(&slot->seq, 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&slot->lock, 0, __ATOMIC_RELEASE);
+}
+
+static int __slot_in_use(const struct _minictrl_state_slot *slot)
+{
+	return slot->state != MINICTRL_SHARED_STATE_FREE
+		&& slot->state != MINICTRL_SHARED_STATE_STOPPED;
+}
+
+static int __slot_owned(struct _minictrl_state_slot *slot, pid_t pid,
+				const char *name)
+{
+	return __slot_in_use(slot)
+		&& slot->pid == pid
+		&& !strncmp(slot->name, name, MINICONTROL_STATE_NAME_MAX);
+}
+
+/* returns the slot locked */
+static struct _minictrl_state_slot *__slot_find(
+				struct _minictrl_state_table *table,
+				const char *name, int claim)
+{
+	struct _minictrl_state_slot *slot;
+	pid_t pid = getpid();
+	int i;
+
+	for (i = 0; i < MINICTRL_STATE_SLOTS; i++) {
+		slot = &table->slots[i];
+		if (!__slot_owned(slot, pid, name))
+			continue;
+
+		if (__slot_lock(slot)) {
+			if (__slot_owned(slot, pid, name))
+				return slot;
+			__slot_unlock(slot);
+		}
+	}
+
+	if (!claim)
+		return NULL;
+
+	/* STOPPED slots are kept for viewers only as long as nobody
+	 * needs the space */
+	for (i = 0; i < MINICTRL_STATE_SLOTS; i++) {
+		slot = &table->slots[i];
+		if (__slot_in_use(slot) && __pid_is_alive(slot->pid))
+			continue;
+
+		if (!__slot_lock(slot))
+			continue;
+
+		if (!__slot_in_use(slot) || !__pid_is_alive(slot->pid)) {
+			slot->pid = pid;
+			strncpy(slot->name, name, MINICONTROL_STATE_NAME_MAX);
+			return slot;
+		}
+		__slot_unlock(slot);
+	}
+
+	return NULL;
+}
+
+int _minictrl_state_publish(const char *name, int state,
+				unsigned int width, unsigned int height,
+				minicontrol_priority_e priority)
+{
+	struct _minictrl_state_table *table;
+	struct _minictrl_state_slot *slot;
+
+	if (!name || strlen(name) >= MINICONTROL_STATE_NAME_MAX)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	table = __state_table_get();
+	if (!table)
+		return MINICONTROL_ERROR_UNKNOWN;
+
+	slot = __slot_find(table, name, 1);
+	if (!slot) {
+		WARN("no free slot in state table for %s", name);
+		return MINICONTROL_ERROR_OUT_OF_MEMORY;
+	}
+
+	slot->state = state;
+	slot->width = width;
+	slot->height = height;
+	slot->priority = priority;
+	slot->updated = __now_usec();
+	__slot_unlock(slot);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+void _minictrl_state_remove(const char *name)
+{
+	struct _minictrl_state_slot *slot;
+
+	if (!name || !g_state_table)
+		return;
+
+	slot = __slot_find(g_state_table, name, 0);
+	if (!slot)
+		return;
+
+	/* the window sent STOP before, tell its viewers */
+	slot->state = MINICTRL_SHARED_STATE_STOPPED;
+	slot->updated = __now_usec();
+	__slot_unlock(slot);
+}
+
+/* every viewer of a provider sees its window go away, the first one to
+ * turn the slot into STOPPED sends STOP for a provider that crashed */
+int _minictrl_state_stop_claim(const char *name)
+{
+	struct _minictrl_state_table *table;
+	struct _minictrl_state_slot *slot;
+	int i;
+
+	if (!name)
+		return 1;
+
+	table = __state_table_get();
+	if (!table)
+		return 1;
+
+	for (i = 0; i < MINICTRL_STATE_SLOTS; i++) {
+		slot = &table->slots[i];
+		if (slot->state == MINICTRL_SHARED_STATE_FREE
+			|| strncmp(slot->name, name, MINICONTROL_STATE_NAME_MAX))
+			continue;
+
+		if (slot->state == MINICTRL_SHARED_STATE_STOPPED)
+			return 0;
+
+		/* the window is gone but the provider is not, it may
+		 * not use this library to send STOP */
+		if (__pid_is_alive(slot->pid))
+			return 1;
+
+		/* another viewer is turning it into STOPPED right now */
+		if (!__slot_lock(slot))
+			return 0;
+
+		if (slot->state == MINICTRL_SHARED_STATE_STOPPED
+			|| strncmp(slot->name, name, MINICONTROL_STATE_NAME_MAX)) {
+			__slot_unlock(slot);
+			return 0;
+		}
+
+		slot->state = MINICTRL_SHARED_STATE_STOPPED;
+		slot->updated = __now_usec();
+		__slot_unlock(slot);
+
+		return 1;
+	}
+
+	/* not published, e.g. the table was full */
+	return 1;
+}
+
+int _minictrl_state_read(minicontrol_state_entry_s *entries,
+				unsigned int max, unsigned int *count)
+{
+	const struct _minictrl_state_table *table;
+	const struct _minictrl_state_slot *slot;
+	struct _minictrl_state_slot copy;
+	unsigned int n = 0;
+	uint32_t seq;
+	int retry;
+	int i;
+
+	if (!entries || !count)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	*count = 0;
+
+	table = __state_table_read_get();
+	if (!table)
+		return MINICONTROL_ERROR_NONE;
+
+	for (i = 0; i < MINICTRL_STATE_SLOTS && n < max; i++) {
+		slot = &table->slots[i];
+
+		for (retry = 0; retry < MINICTRL_STATE_READ_RETRY; retry++) {
+			seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+			if (seq & 1)
+				continue;
+
+			memcpy(&copy, slot, sizeof(copy));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq)
+				break;
+		}
+
+		if (retry == MINICTRL_STATE_READ_RETRY) {
+			WARN("slot[%d] is busy", i);
+			continue;
+		}
+
+		if (copy.state == MINICTRL_SHARED_STATE_FREE
+			|| copy.state == MINICTRL_SHARED_STATE_STOPPED)
+			continue;
+
+		/* provider crashed without cleaning up */
+		if (!__pid_is_alive(copy.pid))
+			continue;
+
+		memcpy(entries[n].name, copy.name, MINICONTROL_STATE_NAME_MAX);
+		entries[n].name[MINICONTROL_STATE_NAME_MAX - 1] = '\0';
+		entries[n].running =
+			(copy.state == MINICTRL_SHARED_STATE_RUNNING);
+		entries[n].pid = copy.pid;
+		entries[n].width = copy.width;
+		entries[n].height = copy.height;
+		entries[n].priority = copy.priority;
+		entries[n].updated_usec = copy.updated;
+		n++;
+	}
+
+	*count = n;
+
+	return MINICONTROL_ERROR_NONE;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <dbus/dbus.h>
+
+#include "minicontrol-error.h"
+#include "minicontrol-internal.h"
+#include "minicontrol-trace.h"
+#include "minicontrol-log.h"
+
+static FILE *g_trace_fp;
+static pthread_once_t g_trace_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void __trace_open(void)
+{
+	const char *path;
+	uint32_t header[2] = { MINICTRL_TRACE_MAGIC, MINICTRL_TRACE_VERSION };
+
+	path = getenv(MINICTRL_TRACE_ENV);
+	if (!path || !path[0])
+		return;
+
+	g_trace_fp = fopen(path, "wb");
+	if (!g_trace_fp) {
+		ERR("fail to open trace file : %s", path);
+		return;
+	}
+
+	if (fwrite(header, sizeof(header), 1, g_trace_fp) != 1) {
+		ERR("fail to write trace header : %s", path);
+		fclose(g_trace_fp);
+		g_trace_fp = NULL;
+		return;
+	}
+
+	INFO("minicontrol trace is recorded to %s", path);
+}
+
+static int __trace_sig_id(const char *sig_name)
+{
+	if (!sig_name)
+		return MINICTRL_TRACE_SIG_UNKNOWN;
+
+	if (!strcmp(sig_name, MINICTRL_DBUS_SIG_START))
+		return MINICTRL_TRACE_SIG_START;
+	else if (!strcmp(sig_name, MINICTRL_DBUS_SIG_STOP))
+		return MINICTRL_TRACE_SIG_STOP;
+	else if (!strcmp(sig_name, MINICTRL_DBUS_SIG_RESIZE))
+		return MINICTRL_TRACE_SIG_RESIZE;
+	else if (!strcmp(sig_name, MINICTRL_DBUS_SIG_RUNNING_REQ))
+		return MINICTRL_TRACE_SIG_RUNNING_REQ;
+	else if (!strcmp(sig_name, MINICTRL_DBUS_SIG_PRIORITY))
+		return MINICTRL_TRACE_SIG_PRIORITY;
+
+	return MINICTRL_TRACE_SIG_UNKNOWN;
+}
+
+const char *_minictrl_trace_sig_name(int signal)
+{
+	switch (signal) {
+	case MINICTRL_TRACE_SIG_START:
+		return MINICTRL_DBUS_SIG_START;
+	case MINICTRL_TRACE_SIG_STOP:
+		return MINICTRL_DBUS_SIG_STOP;
+	case MINICTRL_TRACE_SIG_RESIZE:
+		return MINICTRL_DBUS_SIG_RESIZE;
+	case MINICTRL_TRACE_SIG_RUNNING_REQ:
+		return MINICTRL_DBUS_SIG_RUNNING_REQ;
+	case MINICTRL_TRACE_SIG_PRIORITY:
+		return MINICTRL_DBUS_SIG_PRIORITY;
+	default:
+		return NULL;
+	}
+}
+
+int _minictrl_trace_enabled(void)
+{
+	pthread_once(&g_trace_once, __trace_open);
+
+	return g_trace_fp != NULL;
+}
+
+void _minictrl_trace_write(int dir, const char *sig_name,
+				const char *name, unsigned int width,
+				unsigned int height, unsigned int priority)
+{
+	struct _minictrl_trace_record rec;
+	struct timespec ts;
+	size_t name_len = 0;
+
+	if (!_minictrl_trace_enabled())
+		return;
+
+	if (name)
+		name_len = strlen(name);
+	if (name_len > UINT16_MAX)
+		name_len = UINT16_MAX;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	rec.timestamp = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+	rec.dir = dir;
+	rec.signal = __trace_sig_id(sig_name);
+	rec.name_len = name_len;
+	rec.width = width;
+	rec.height = height;
+	rec.priority = priority;
+
+	pthread_mutex_lock(&g_trace_lock);
+	fwrite(&rec, sizeof(rec), 1, g_trace_fp);
+	if (name_len)
+		fwrite(name, name_len, 1, g_trace_fp);
+	fflush(g_trace_fp);
+	pthread_mutex_unlock(&g_trace_lock);
+}
+
+void _minictrl_trace_message(int dir, DBusMessage *msg)
+{
+	DBusMessageIter iter;
+	const char *name = NULL;
+	unsigned int value[3] = { 0, };
+	int i = 0;
+
+	if (!_minictrl_trace_enabled())
+		return;
+
+	/* records of a batch are traced as the signals they stand for */
+	if (dbus_message_is_signal(msg, dbus_message_get_interface(msg),
+					MINICTRL_DBUS_SIG_BATCH)) {
+		minicontrol_event_s events[MINICTRL_BATCH_MAX];
+		unsigned int count = 0;
+
+		_minictrl_event_batch_decode(msg, events,
+					MINICTRL_BATCH_MAX, &count);
+		for (i = 0; i < (int)count; i++)
+			_minictrl_trace_write(dir,
+				_minictrl_event_sig_name(events[i].action),
+				events[i].name, events[i].width,
+				events[i].height, events[i].priority);
+		return;
+	}
+
+	if (dbus_message_iter_init(msg, &iter)) {
+		if (dbus_message_iter_get_arg_type(&iter) == DBUS_TYPE_STRING) {
+			dbus_message_iter_get_basic(&iter, &name);
+			dbus_message_iter_next(&iter);
+		}
+
+		while (i < 3 && dbus_message_iter_get_arg_type(&iter)
+						== DBUS_TYPE_UINT32) {
+			dbus_message_iter_get_basic(&iter, &value[i++]);
+			dbus_message_iter_next(&iter);
+		}
+	}
+
+	/* priority change carries the priority only */
+	if (dbus_message_is_signal(msg, dbus_message_get_interface(msg),
+					MINICTRL_DBUS_SIG_PRIORITY)) {
+		value[2] = value[0];
+		value[0] = 0;
+	}
+
+	_minictrl_trace_write(dir, dbus_message_get_member(msg), name,
+				value[0], value[1], value[2]);
+}
+
+int _minictrl_trace_read_header(FILE *fp)
+{
+	uint32_t header[2];
+
+	if (fread(header, sizeof(header), 1, fp) != 1)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	if (header[0] != MINICTRL_TRACE_MAGIC
+		|| header[1] != MINICTRL_TRACE_VERSION)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+int _minictrl_trace_read(FILE *fp, struct _minictrl_trace_record *rec,
+				char *name, unsigned int name_size)
+{
+	if (fread(rec, sizeof(*rec), 1, fp) != 1)
+		return MINICONTROL_ERROR_UNKNOWN;
+
+	if (rec->name_len >= name_size)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	if (rec->name_len && fread(name, rec->name_len, 1, fp) != 1)
+		return MINICONTROL_ERROR_UNKNOWN;
+
+	name[rec->name_len] = '\0';
+
+	return MINICONTROL_ERROR_NONE;
+}
@@ -14,19 +14,569 @@
  * limitations under the License.
  */
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <Elementary.h>
 #include <Ecore_Evas.h>
 
+#include "minicontrol-error.h"
 #include "minicontrol-internal.h"
 #include "minicontrol-type.h"
 #include "minicontrol-viewer.h"
 #include "minicontrol-log.h"
 
 #define MINICTRL_PLUG_DATA_KEY "__minictrl_plug_name"
+#define MINICTRL_VIEWER_DATA_KEY "__minictrl_viewer_data"
+/* set on the ecore evas of the plug image once the provider is gone */
+#define MINICTRL_PLUG_GONE_KEY "__minictrl_plug_gone"
+
+#define MINICTRL_THUMB_PREFIX "thumb-"
+#define MINICTRL_THUMB_TMP_PREFIX "thumb-tmp-"
+#define MINICTRL_THUMB_MAGIC 0x424d5448 /* "HTMB" */
+#define MINICTRL_THUMB_VERSION 1
+#define MINICTRL_THUMB_MAX_SIZE 256
+#define MINICTRL_THUMB_NAME_MAX 256
+/* names change with every provider instance, keep the latest ones */
+#define MINICTRL_THUMB_CACHE_MAX 32
+/* age of a temporary file left behind by a crashed viewer, in seconds */
+#define MINICTRL_THUMB_TMP_STALE 60
+
+/* providers this viewer already sent STOP for */
+#define MINICTRL_STOP_HISTORY_SIZE 16
+
+/* cache file layout, followed by width * height ARGB pixels */
+struct _minictrl_thumb_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	char name[MINICTRL_THUMB_NAME_MAX];
+};
+
+static int g_thumb_enabled;
+/* suspend state of a viewer, kept on the plug */
+struct _minictrl_viewer {
+	Evas_Object *plug;
+	int suspended; /* by minicontrol_viewer_suspend_set() */
+	int out_of_view; /* detected while auto suspend is enabled */
+	int applied;
+	int r, g, b, a;
+	Eina_List *clips; /* clippers of the plug watched for auto suspend */
+};
+
+/* changes of a clipper which may move the plug out of view */
+static const Evas_Callback_Type g_clip_events[] = {
+	EVAS_CALLBACK_MOVE,
+	EVAS_CALLBACK_RESIZE,
+	EVAS_CALLBACK_SHOW,
+	EVAS_CALLBACK_HIDE,
+};
+
+#define MINICTRL_CLIP_EVENT_COUNT \
+	(int)(sizeof(g_clip_events) / sizeof(g_clip_events[0]))
+
+static int g_auto_suspend;
+static Eina_List *g_viewers;
+static const char *g_stop_history[MINICTRL_STOP_HISTORY_SIZE];
+static unsigned int g_stop_history_pos;
+
+/* names carry the pid and a serial of the provider instance, so a name
+ * seen here was already stopped by another plug of this viewer.
+ * svr_name has to be interned. */
+static int __stop_history_check_n_add(const char *svr_name)
+{
+	int i;
+
+	for (i = 0; i < MINICTRL_STOP_HISTORY_SIZE; i++) {
+		if (g_stop_history[i] == svr_name)
+			return 1;
+	}
+
+	eina_stringshare_del(g_stop_history[g_stop_history_pos]);
+	g_stop_history[g_stop_history_pos] = eina_stringshare_ref(svr_name);
+	g_stop_history_pos = (g_stop_history_pos + 1)
+				% MINICTRL_STOP_HISTORY_SIZE;
+
+	return 0;
+}
+
+/* file name of the cache entry in the runtime directory */
+static void __thumb_file(const char *svr_name, char *file, int size)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL; /* FNV-1a */
+	const unsigned char *p;
+
+	for (p = (const unsigned char *)svr_name; *p; p++) {
+		hash ^= *p;
+		hash *= 0x100000001b3ULL;
+	}
+
+	snprintf(file, size, MINICTRL_THUMB_PREFIX "%016llx",
+			(unsigned long long)hash);
+}
+
+static int __thumb_path(const char *svr_name, char *path, int size)
+{
+	char file[64];
+	int len;
+
+	if (_minictrl_runtime_dir_get(path, size) != MINICONTROL_ERROR_NONE)
+		return -1;
+
+	__thumb_file(svr_name, file, sizeof(file));
+	len = strlen(path);
+	if (snprintf(path + len, size - len, "/%s", file) >= size - len)
+		return -1;
+
+	return 0;
+}
+
+static void __thumb_remove(const char *svr_name)
+{
+	char path[PATH_MAX];
+
+	if (__thumb_path(svr_name, path, sizeof(path)) < 0)
+		return;
+
+	unlink(path);
+}
+
+struct _minictrl_thumb_entry {
+	char name[NAME_MAX + 1];
+	time_t mtime;
+};
+
+static int __thumb_entry_cmp(const void *a, const void *b)
+{
+	const struct _minictrl_thumb_entry *x = a;
+	const struct _minictrl_thumb_entry *y = b;
+
+	/* newest first */
+	return (y->mtime > x->mtime) - (y->mtime < x->mtime);
+}
+
+/* entries of providers that crashed or were never shown again are only
+ * dropped here, keep the most recently saved ones */
+static void __thumb_evict(void)
+{
+	struct _minictrl_thumb_entry *entries = NULL;
+	struct _minictrl_thumb_entry *tmp;
+	char dir[PATH_MAX];
+	struct dirent *de;
+	struct stat st;
+	unsigned int size = 0;
+	unsigned int n = 0;
+	unsigned int i;
+	time_t now = time(NULL);
+	DIR *d;
+
+	if (_minictrl_runtime_dir_get(dir, sizeof(dir))
+			!= MINICONTROL_ERROR_NONE)
+		return;
+
+	d = opendir(dir);
+	if (!d)
+		return;
+
+	while ((de = readdir(d))) {
+		if (strncmp(de->d_name, MINICTRL_THUMB_PREFIX,
+				strlen(MINICTRL_THUMB_PREFIX)))
+			continue;
+
+		if (fstatat(dirfd(d), de->d_name, &st, AT_SYMLINK_NOFOLLOW) < 0
+			|| !S_ISREG(st.st_mode))
+			continue;
+
+		if (!strncmp(de->d_name, MINICTRL_THUMB_TMP_PREFIX,
+				strlen(MINICTRL_THUMB_TMP_PREFIX))) {
+			if (now - st.st_mtime > MINICTRL_THUMB_TMP_STALE)
+				unlinkat(dirfd(d), de->d_name, 0);
+			continue;
+		}
+
+		if (n == size) {
+			size = size ? size * 2 : MINICTRL_THUMB_CACHE_MAX * 2;
+			tmp = realloc(entries, size * sizeof(*entries));
+			if (!tmp)
+				break;
+			entries = tmp;
+		}
+
+		snprintf(entries[n].name, sizeof(entries[n].name), "%s",
+				de->d_name);
+		entries[n].mtime = st.st_mtime;
+		n++;
+	}
+
+	if (n > MINICTRL_THUMB_CACHE_MAX) {
+		qsort(entries, n, sizeof(*entries), __thumb_entry_cmp);
+		for (i = MINICTRL_THUMB_CACHE_MAX; i < n; i++)
+			unlinkat(dirfd(d), entries[i].name, 0);
+		DBG("%u thumbnails evicted", n - MINICTRL_THUMB_CACHE_MAX);
+	}
+
+	closedir(d);
+	free(entries);
+}
+
+/* store a downscaled copy of the last frame shown for svr_name */
+static void __thumb_save(const char *svr_name, Evas_Object *img)
+{
+	struct _minictrl_thumb_header *header;
+	char path[PATH_MAX];
+	char tmp_path[PATH_MAX];
+	const uint32_t *src;
+	uint32_t *dst;
+	size_t size;
+	void *map;
+	int iw = 0;
+	int ih = 0;
+	int stride;
+	int len;
+	int tw;
+	int th;
+	int x;
+	int y;
+	int fd;
+
+	if (strlen(svr_name) >= MINICTRL_THUMB_NAME_MAX)
+		return;
+
+	evas_object_image_size_get(img, &iw, &ih);
+	if (iw <= 0 || ih <= 0)
+		return;
+
+	src = evas_object_image_data_get(img, EINA_FALSE);
+	if (!src)
+		return;
+
+	stride = evas_object_image_stride_get(img) / 4;
+	if (stride < iw)
+		stride = iw;
+
+	tw = iw;
+	th = ih;
+	if (tw > MINICTRL_THUMB_MAX_SIZE || th > MINICTRL_THUMB_MAX_SIZE) {
+		if (iw >= ih) {
+			tw = MINICTRL_THUMB_MAX_SIZE;
+			th = ih * MINICTRL_THUMB_MAX_SIZE / iw;
+		} else {
+			th = MINICTRL_THUMB_MAX_SIZE;
+			tw = iw * MINICTRL_THUMB_MAX_SIZE / ih;
+		}
+		if (tw < 1)
+			tw = 1;
+		if (th < 1)
+			th = 1;
+	}
+
+	if (__thumb_path(svr_name, path, sizeof(path)) < 0)
+		return;
+
+	/* the directory is private, a unique name still keeps concurrent
+	 * viewers of this user apart */
+	if (_minictrl_runtime_dir_get(tmp_path, sizeof(tmp_path))
+			!= MINICONTROL_ERROR_NONE)
+		return;
+	len = strlen(tmp_path);
+	snprintf(tmp_path + len, sizeof(tmp_path) - len,
+			"/" MINICTRL_THUMB_TMP_PREFIX "XXXXXX");
+
+	fd = mkstemp(tmp_path);
+	if (fd < 0) {
+		ERR("fail to create %s", tmp_path);
+		return;
+	}
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	size = sizeof(struct _minictrl_thumb_header) + tw * th * 4;
+	if (ftruncate(fd, size) < 0) {
+		ERR("fail to resize %s", tmp_path);
+		goto error_n_return;
+	}
+
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		ERR("fail to map %s", tmp_path);
+		goto error_n_return;
+	}
+
+	header = map;
+	header->magic = MINICTRL_THUMB_MAGIC;
+	header->version = MINICTRL_THUMB_VERSION;
+	header->width = tw;
+	header->height = th;
+	memset(header->name, 0x00, sizeof(header->name));
+	strcpy(header->name, svr_name);
+
+	/* nearest neighbour is good enough for a placeholder */
+	dst = (uint32_t *)(header + 1);
+	for (y = 0; y < th; y++) {
+		const uint32_t *row = src + (y * ih / th) * stride;
+
+		for (x = 0; x < tw; x++)
+			*dst++ = row[x * iw / tw];
+	}
+
+	munmap(map, size);
+	close(fd);
+
+	if (rename(tmp_path, path) < 0) {
+		ERR("fail to rename %s", tmp_path);
+		unlink(tmp_path);
+		return;
+	}
+
+	__thumb_evict();
+
+	return;
+
+error_n_return:
+	close(fd);
+	unlink(tmp_path);
+}
+
+/* show the cached frame of svr_name until the first live frame arrives */
+static void __thumb_load(const char *svr_name, Evas_Object *img)
+{
+	const struct _minictrl_thumb_header *header;
+	char file[64];
+	struct stat st;
+	void *map;
+	int w = 0;
+	int h = 0;
+	int fd;
+
+	evas_object_image_size_get(img, &w, &h);
+	if (w > 1 && h > 1)
+		return;
+
+	/* only files this user wrote in its private directory are shown */
+	__thumb_file(svr_name, file, sizeof(file));
+	fd = _minictrl_runtime_open(file, O_RDONLY, 0);
+	if (fd < 0)
+		return;
+
+	if (fstat(fd, &st) < 0
+		|| st.st_size < (off_t)sizeof(struct _minictrl_thumb_header)) {
+		close(fd);
+		return;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return;
+
+	header = map;
+	if (header->magic == MINICTRL_THUMB_MAGIC
+		&& header->version == MINICTRL_THUMB_VERSION
+		&& header->width && header->height
+		&& header->width <= MINICTRL_THUMB_MAX_SIZE
+		&& header->height <= MINICTRL_THUMB_MAX_SIZE
+		&& st.st_size >= (off_t)(sizeof(*header)
+				+ header->width * header->height * 4)
+		&& !strncmp(header->name, svr_name, sizeof(header->name))) {
+		evas_object_image_size_set(img, header->width, header->height);
+		evas_object_image_data_copy_set(img, (void *)(header + 1));
+		evas_object_image_data_update_add(img, 0, 0,
+					header->width, header->height);
+		DBG("placeholder for %s [%ux%u]", svr_name,
+					header->width, header->height);
+	}
+
+	munmap(map, st.st_size);
+}
+
+/* a fully transparent image is skipped by the renderer, so frames of
+ * the provider are neither drawn nor uploaded. Hiding it instead would
+ * hide the provider window and make it send STOP. */
+static void __viewer_suspend_apply(Evas_Object *plug,
+				struct _minictrl_viewer *viewer)
+{
+	Evas_Object *plug_img;
+	Evas_Coord w = 0;
+	Evas_Coord h = 0;
+	int suspend = viewer->suspended || viewer->out_of_view;
+
+	if (suspend == viewer->applied)
+		return;
+
+	plug_img = elm_plug_image_object_get(plug);
+	if (!plug_img)
+		return;
+
+	viewer->applied = suspend;
+
+	if (suspend) {
+		evas_object_color_get(plug_img, &viewer->r, &viewer->g,
+					&viewer->b, &viewer->a);
+		evas_object_color_set(plug_img, 0, 0, 0, 0);
+		DBG("viewer[%p] is suspended", plug);
+		return;
+	}
+
+	evas_object_color_set(plug_img, viewer->r, viewer->g,
+				viewer->b, viewer->a);
+
+	/* show the latest frame as a whole, not only what changed since */
+	evas_object_image_size_get(plug_img, &w, &h);
+	evas_object_image_data_update_add(plug_img, 0, 0, w, h);
+	DBG("viewer[%p] is resumed", plug);
+}
+
+static int __rect_intersect(Evas_Coord *x, Evas_Coord *y,
+			Evas_Coord *w, Evas_Coord *h,
+			Evas_Coord ox, Evas_Coord oy,
+			Evas_Coord ow, Evas_Coord oh)
+{
+	Evas_Coord x2 = *x + *w;
+	Evas_Coord y2 = *y + *h;
+
+	if (*x < ox)
+		*x = ox;
+	if (*y < oy)
+		*y = oy;
+	if (x2 > ox + ow)
+		x2 = ox + ow;
+	if (y2 > oy + oh)
+		y2 = oy + oh;
+
+	*w = x2 - *x;
+	*h = y2 - *y;
+
+	return *w > 0 && *h > 0;
+}
+
+/* out of view when scrolled out of its clippers or the canvas */
+static int __viewer_out_of_view(Evas_Object *plug)
+{
+	Evas_Object *clip;
+	Evas_Coord x, y, w, h;
+	Evas_Coord cx, cy, cw, ch;
+
+	evas_object_geometry_get(plug, &x, &y, &w, &h);
+	evas_output_viewport_get(evas_object_evas_get(plug),
+				&cx, &cy, &cw, &ch);
+	if (!__rect_intersect(&x, &y, &w, &h, cx, cy, cw, ch))
+		return 1;
+
+	for (clip = evas_object_clip_get(plug); clip;
+			clip = evas_object_clip_get(clip)) {
+		if (!evas_object_visible_get(clip))
+			return 1;
+
+		evas_object_geometry_get(clip, &cx, &cy, &cw, &ch);
+		if (!__rect_intersect(&x, &y, &w, &h, cx, cy, cw, ch))
+			return 1;
+	}
+
+	return 0;
+}
+
+static void _minictrl_plug_clip_changed(void *data, Evas *e,
+			Evas_Object *obj, void *event_info);
+static void _minictrl_plug_clip_del(void *data, Evas *e,
+			Evas_Object *obj, void *event_info);
+
+static void __viewer_clip_callbacks_del(Evas_Object *clip,
+				struct _minictrl_viewer *viewer)
+{
+	int i;
+
+	for (i = 0; i < MINICTRL_CLIP_EVENT_COUNT; i++)
+		evas_object_event_callback_del_full(clip, g_clip_events[i],
+				_minictrl_plug_clip_changed, viewer);
+	evas_object_event_callback_del_full(clip, EVAS_CALLBACK_DEL,
+				_minictrl_plug_clip_del, viewer);
+}
+
+static void __viewer_clips_unwatch(struct _minictrl_viewer *viewer)
+{
+	Evas_Object *clip;
+
+	EINA_LIST_FREE(viewer->clips, clip)
+		__viewer_clip_callbacks_del(clip, viewer);
+}
+
+/* clippers may be set or unset at any time, follow the current chain */
+static void __viewer_clips_watch(struct _minictrl_viewer *viewer)
+{
+	Evas_Object *clip;
+	Eina_List *l;
+	int i;
+
+	for (l = viewer->clips, clip = evas_object_clip_get(viewer->plug);
+			l && clip && l->data == clip;
+			l = l->next, clip = evas_object_clip_get(clip))
+		;
+
+	if (!l && !clip)
+		return;
+
+	__viewer_clips_unwatch(viewer);
+
+	for (clip = evas_object_clip_get(viewer->plug); clip;
+			clip = evas_object_clip_get(clip)) {
+		for (i = 0; i < MINICTRL_CLIP_EVENT_COUNT; i++)
+			evas_object_event_callback_add(clip, g_clip_events[i],
+					_minictrl_plug_clip_changed, viewer);
+		evas_object_event_callback_add(clip, EVAS_CALLBACK_DEL,
+					_minictrl_plug_clip_del, viewer);
+		viewer->clips = eina_list_append(viewer->clips, clip);
+	}
+}
+
+static void __viewer_view_check(struct _minictrl_viewer *viewer)
+{
+	if (g_auto_suspend) {
+		__viewer_clips_watch(viewer);
+		viewer->out_of_view = __viewer_out_of_view(viewer->plug);
+	} else {
+		__viewer_clips_unwatch(viewer);
+		viewer->out_of_view = 0;
+	}
+
+	__viewer_suspend_apply(viewer->plug, viewer);
+}
+
+static void _minictrl_plug_clip_changed(void *data, Evas *e,
+			Evas_Object *obj, void *event_info)
+{
+	__viewer_view_check(data);
+}
+
+static void _minictrl_plug_clip_del(void *data, Evas *e,
+			Evas_Object *obj, void *event_info)
+{
+	struct _minictrl_viewer *viewer = data;
+
+	__viewer_clip_callbacks_del(obj, viewer);
+	viewer->clips = eina_list_remove(viewer->clips, obj);
+}
+
+static void _minictrl_plug_geometry_changed(void *data, Evas *e,
+			Evas_Object *obj, void *event_info)
+{
+	struct _minictrl_viewer *viewer;
+
+	viewer = evas_object_data_get(obj, MINICTRL_VIEWER_DATA_KEY);
+	if (!viewer)
+		return;
+
+	__viewer_view_check(viewer);
+}
 
 static void _minictrl_plug_server_del(Ecore_Evas *ee)
 {
-	char *svr_name = NULL;
+	const char *svr_name = NULL;
 
 	svr_name = ecore_evas_data_get(ee, MINICTRL_PLUG_DATA_KEY);
 	if (!svr_name) {
@@ -36,6 +586,23 @@ static void _minictrl_plug_server_del(Ecore_Evas *ee)
 
 	INFO("server - %s is deleted", svr_name);
 
+	/* the image left in the plug is not the provider any more */
+	ecore_evas_data_set(ee, MINICTRL_PLUG_GONE_KEY, ee);
+
+	if (g_thumb_enabled)
+		__thumb_remove(svr_name);
+
+	if (__stop_history_check_n_add(svr_name)) {
+		DBG("STOP for %s is already sent", svr_name);
+		return;
+	}
+
+	/* the provider or a viewer in another process sent it */
+	if (!_minictrl_state_stop_claim(svr_name)) {
+		DBG("STOP for %s is sent by another process", svr_name);
+		return;
+	}
+
 	/* send message to remve plug */
 	_minictrl_provider_message_send(MINICTRL_DBUS_SIG_STOP,
 					svr_name, 0, 0,
@@ -45,18 +612,40 @@ static void _minictrl_plug_server_del(Ecore_Evas *ee)
 static void _minictrl_plug_del(void *data, Evas *e,
 			Evas_Object *obj, void *event_info)
 {
+	struct _minictrl_viewer *viewer;
+	Evas_Object *plug_img = NULL;
 	Ecore_Evas *ee = NULL;
-	char *svr_name = NULL;
+	const char *svr_name = NULL;
 
-	ee = ecore_evas_ecore_evas_get(evas_object_evas_get(obj));
+	viewer = evas_object_data_del(obj, MINICTRL_VIEWER_DATA_KEY);
+	if (viewer) {
+		__viewer_clips_unwatch(viewer);
+		g_viewers = eina_list_remove(g_viewers, viewer);
+		free(viewer);
+	}
+
+	plug_img = elm_plug_image_object_get(obj);
+	if (!plug_img)
+		return;
+
+	/* the name is kept on the ecore evas of the plug image */
+	ee = ecore_evas_object_ecore_evas_get(plug_img);
 	if (!ee)
 		return;
 
 	svr_name = ecore_evas_data_get(ee, MINICTRL_PLUG_DATA_KEY);
-	if (svr_name)
-		free(svr_name);
+	if (svr_name) {
+		if (g_thumb_enabled
+			&& !ecore_evas_data_get(ee, MINICTRL_PLUG_GONE_KEY))
+			__thumb_save(svr_name, plug_img);
+
+		_minictrl_resource_del(MINICTRL_RESOURCE_PLUG_NAME,
+					strlen(svr_name) + 1);
+		eina_stringshare_del(svr_name);
+	}
 
 	ecore_evas_data_set(ee, MINICTRL_PLUG_DATA_KEY, NULL);
+	ecore_evas_data_set(ee, MINICTRL_PLUG_GONE_KEY, NULL);
 }
 
 EXPORT_API
@@ -68,6 +657,7 @@ Evas_Object *minicontrol_viewer_image_object_get(const Evas_Object *obj)
 EXPORT_API Evas_Object *minicontrol_viewer_add(Evas_Object *parent,
 						const char *svr_name)
 {
+	struct _minictrl_viewer *viewer;
 	Evas_Object *plug = NULL;
 	Evas_Object *plug_img = NULL;
 	Ecore_Evas *ee = NULL;
@@ -86,13 +676,103 @@ EXPORT_API Evas_Object *minicontrol_viewer_add(Evas_Object *parent,
 
 	plug_img = elm_plug_image_object_get(plug);
 
+	if (g_thumb_enabled)
+		__thumb_load(svr_name, plug_img);
+
 	ee = ecore_evas_object_ecore_evas_get(plug_img);
-	ecore_evas_data_set(ee, MINICTRL_PLUG_DATA_KEY, strdup(svr_name));
+	/* plugs of the same provider share the name */
+	ecore_evas_data_set(ee, MINICTRL_PLUG_DATA_KEY,
+				eina_stringshare_add(svr_name));
+	_minictrl_resource_add(MINICTRL_RESOURCE_PLUG_NAME,
+				strlen(svr_name) + 1);
 	ecore_evas_callback_delete_request_set(ee, _minictrl_plug_server_del);
 
 	evas_object_event_callback_add(plug, EVAS_CALLBACK_DEL,
 					_minictrl_plug_del, plug);
 
+	viewer = calloc(1, sizeof(struct _minictrl_viewer));
+	if (viewer) {
+		viewer->plug = plug;
+		g_viewers = eina_list_append(g_viewers, viewer);
+		evas_object_data_set(plug, MINICTRL_VIEWER_DATA_KEY, viewer);
+		evas_object_event_callback_add(plug, EVAS_CALLBACK_MOVE,
+				_minictrl_plug_geometry_changed, NULL);
+		evas_object_event_callback_add(plug, EVAS_CALLBACK_RESIZE,
+				_minictrl_plug_geometry_changed, NULL);
+		evas_object_event_callback_add(plug, EVAS_CALLBACK_SHOW,
+				_minictrl_plug_geometry_changed, NULL);
+	} else {
+		ERR("fail to alloc viewer data, it can not be suspended");
+	}
+
 	return plug;
 }
 
+EXPORT_API void minicontrol_viewer_thumbnail_cache_set(Eina_Bool enable)
+{
+	g_thumb_enabled = enable ? 1 : 0;
+}
+
+EXPORT_API minicontrol_error_e minicontrol_viewer_suspend_set(
+				Evas_Object *obj, Eina_Bool suspend)
+{
+	struct _minictrl_viewer *viewer;
+
+	if (!obj)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	viewer = evas_object_data_get(obj, MINICTRL_VIEWER_DATA_KEY);
+	if (!viewer)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	viewer->suspended = !!suspend;
+	__viewer_suspend_apply(obj, viewer);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API Eina_Bool minicontrol_viewer_suspended_get(const Evas_Object *obj)
+{
+	struct _minictrl_viewer *viewer;
+
+	if (!obj)
+		return EINA_FALSE;
+
+	viewer = evas_object_data_get(obj, MINICTRL_VIEWER_DATA_KEY);
+	if (!viewer)
+		return EINA_FALSE;
+
+	return viewer->applied ? EINA_TRUE : EINA_FALSE;
+}
+
+EXPORT_API void minicontrol_viewer_auto_suspend_set(Eina_Bool enable)
+{
+	struct _minictrl_viewer *viewer;
+	Eina_List *l;
+
+	if (g_auto_suspend == (enable ? 1 : 0))
+		return;
+
+	g_auto_suspend = enable ? 1 : 0;
+
+	/* viewers already out of view would wait for their next move */
+	EINA_LIST_FOREACH(g_viewers, l, viewer)
+		__viewer_view_check(viewer);
+}
+
+EXPORT_API minicontrol_error_e minicontrol_viewer_resource_get(
+					minicontrol_resource_s *res)
+{
+	if (!res)
+		return MINICONTROL_ERROR_INVALID_PARAMETER;
+
+	_minictrl_resource_get(res);
+
+	return MINICONTROL_ERROR_NONE;
+}
+
+EXPORT_API void minicontrol_viewer_resource_dump(void)
+{
+	_minictrl_resource_dump("viewer");
+}
+
@@ -0,0 +1,379 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Feeds messages to the provider signal decoder without a bus.
+ *
+ * usage: minicontrol-decode [-n count] [-w] [input...]
+ *   -n count : decode count generated signals and report messages/sec
+ *   -w       : in throughput mode, also parse each message from its
+ *              wire format as the bus connection would
+ *   input    : decode each file as fuzzer input, e.g. a crash or corpus
+ *
+ * Built with -DMINICTRL_DECODE_FUZZER and -fsanitize=fuzzer it becomes a
+ * libFuzzer target. Each input is tried as a marshalled message first and
+ * then as a description of a signal with arbitrary arguments.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dbus/dbus.h>
+
+#include "minicontrol-internal.h"
+
+#define DECODE_PATH "/org/tizen/minicontrol"
+#define DECODE_INTERFACE "org.tizen.minicontrol.signal"
+#define DECODE_SAMPLE_COUNT 64
+#define DECODE_ARG_MAX 8
+#define DECODE_STRING_MAX 256
+
+static const struct {
+	const char *member;
+	minicontrol_action_e action;
+} g_signals[] = {
+	{ MINICTRL_DBUS_SIG_START, MINICONTROL_ACTION_START },
+	{ MINICTRL_DBUS_SIG_STOP, MINICONTROL_ACTION_STOP },
+	{ MINICTRL_DBUS_SIG_RESIZE, MINICONTROL_ACTION_RESIZE },
+	{ MINICTRL_DBUS_SIG_PRIORITY, MINICONTROL_ACTION_PRIORITY },
+};
+
+#define DECODE_SIGNAL_COUNT (sizeof(g_signals) / sizeof(g_signals[0]))
+
+static volatile unsigned long g_sink;
+
+static void _consume(const minicontrol_event_s *event)
+{
+	/* touch every field so the decoder can not be optimised away */
+	g_sink += event->action + event->name_len + event->width
+		+ event->height + event->priority
+		+ (event->category ? strlen(event->category) : 0);
+}
+
+/* run every decode path over the message, the member is not trusted */
+static void _decode_all(DBusMessage *msg)
+{
+	minicontrol_event_s event;
+	unsigned int i;
+
+	for (i = 0; i < DECODE_SIGNAL_COUNT; i++) {
+		if (!_minictrl_event_decode(msg, g_signals[i].action, &event))
+			_consume(&event);
+	}
+}
+
+static int _append_fuzz_args(DBusMessage *msg, const uint8_t *data,
+				size_t size)
+{
+	char str[DECODE_STRING_MAX + 1];
+	const char *p = str;
+	dbus_uint32_t u;
+	dbus_int32_t n;
+	dbus_bool_t b;
+	double d;
+	size_t pos = 0;
+	size_t len;
+	size_t i;
+	int args = 0;
+
+	while (pos < size && args++ < DECODE_ARG_MAX) {
+		switch (data[pos++] % 5) {
+		case 0:
+			len = pos < size ? data[pos++] : 0;
+			if (len > size - pos)
+				len = size - pos;
+			/* strings have to be valid UTF-8 to be appended */
+			for (i = 0; i < len; i++)
+				str[i] = 0x20 + data[pos + i] % 0x5f;
+			str[len] = '\0';
+			pos += len;
+			if (!dbus_message_append_args(msg,
+					DBUS_TYPE_STRING, &p,
+					DBUS_TYPE_INVALID))
+				return -1;
+			break;
+		case 1:
+			u = 0;
+			for (i = 0; i < 4 && pos < size; i++)
+				u = (u << 8) | data[pos++];
+			if (!dbus_message_append_args(msg,
+					DBUS_TYPE_UINT32, &u,
+					DBUS_TYPE_INVALID))
+				return -1;
+			break;
+		case 2:
+			n = pos < size ? (int8_t)data[pos++] : 0;
+			if (!dbus_message_append_args(msg,
+					DBUS_TYPE_INT32, &n,
+					DBUS_TYPE_INVALID))
+				return -1;
+			break;
+		case 3:
+			b = pos < size ? data[pos++] & 1 : 0;
+			if (!dbus_message_append_args(msg,
+					DBUS_TYPE_BOOLEAN, &b,
+					DBUS_TYPE_INVALID))
+				return -1;
+			break;
+		default:
+			d = pos < size ? data[pos++] : 0;
+			if (!dbus_message_append_args(msg,
+					DBUS_TYPE_DOUBLE, &d,
+					DBUS_TYPE_INVALID))
+				return -1;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static void _decode_input(const uint8_t *data, size_t size)
+{
+	DBusMessage *msg;
+	DBusError err;
+
+	if (!size)
+		return;
+
+	dbus_error_init(&err);
+	msg = dbus_message_demarshal((const char *)data, size, &err);
+	if (msg) {
+		_decode_all(msg);
+		dbus_message_unref(msg);
+	}
+	dbus_error_free(&err);
+
+	msg = dbus_message_new_signal(DECODE_PATH, DECODE_INTERFACE,
+			g_signals[data[0] % DECODE_SIGNAL_COUNT].member);
+	if (!msg)
+		return;
+
+	if (!_append_fuzz_args(msg, data + 1, size - 1))
+		_decode_all(msg);
+
+	dbus_message_unref(msg);
+}
+
+#ifdef MINICTRL_DECODE_FUZZER
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	_decode_input(data, size);
+
+	return 0;
+}
+#else
+static int _decode_file(const char *path)
+{
+	uint8_t *data = NULL;
+	size_t size = 0;
+	size_t n;
+	FILE *fp;
+
+	fp = fopen(path, "rb");
+	if (!fp) {
+		perror(path);
+		return -1;
+	}
+
+	do {
+		uint8_t *tmp = realloc(data, size + 4096);
+		if (!tmp) {
+			free(data);
+			fclose(fp);
+			return -1;
+		}
+		data = tmp;
+		n = fread(data + size, 1, 4096, fp);
+		size += n;
+	} while (n == 4096);
+
+	fclose(fp);
+
+	_decode_input(data, size);
+	free(data);
+
+	return 0;
+}
+
+static DBusMessage *_sample_new(int i)
+{
+	const char *category = "bench";
+	char name[64];
+	const char *p = name;
+	dbus_uint32_t w = 480;
+	dbus_uint32_t h = 100 + i;
+	dbus_uint32_t pri = MINICONTROL_PRIORITY_MIDDLE;
+	unsigned int sig = i % DECODE_SIGNAL_COUNT;
+	DBusMessage *msg;
+	dbus_bool_t ret;
+
+	snprintf(name, sizeof(name), "bench-%d-[%d-%d]", i, getpid(), i);
+
+	msg = dbus_message_new_signal(DECODE_PATH, DECODE_INTERFACE,
+					g_signals[sig].member);
+	if (!msg)
+		return NULL;
+
+	switch (g_signals[sig].action) {
+	case MINICONTROL_ACTION_START:
+		ret = dbus_message_append_args(msg, DBUS_TYPE_STRING, &p,
+				DBUS_TYPE_UINT32, &w, DBUS_TYPE_UINT32, &h,
+				DBUS_TYPE_UINT32, &pri,
+				DBUS_TYPE_STRING, &category,
+				DBUS_TYPE_INVALID);
+		break;
+	case MINICONTROL_ACTION_PRIORITY:
+		ret = dbus_message_append_args(msg, DBUS_TYPE_STRING, &p,
+				DBUS_TYPE_UINT32, &pri,
+				DBUS_TYPE_INVALID);
+		break;
+	default:
+		/* STOP carries the same arguments as RESIZE on the wire */
+		ret = dbus_message_append_args(msg, DBUS_TYPE_STRING, &p,
+				DBUS_TYPE_UINT32, &w, DBUS_TYPE_UINT32, &h,
+				DBUS_TYPE_UINT32, &pri,
+				DBUS_TYPE_INVALID);
+		break;
+	}
+
+	if (!ret) {
+		dbus_message_unref(msg);
+		return NULL;
+	}
+
+	return msg;
+}
+
+static double _now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int _throughput(unsigned long count, int wire)
+{
+	DBusMessage *samples[DECODE_SAMPLE_COUNT];
+	char *wires[DECODE_SAMPLE_COUNT];
+	int lens[DECODE_SAMPLE_COUNT];
+	minicontrol_event_s event;
+	DBusMessage *msg;
+	unsigned long failed = 0;
+	unsigned long i;
+	double start;
+	double elapsed;
+	int ret = 0;
+	int s;
+
+	memset(samples, 0, sizeof(samples));
+	memset(wires, 0, sizeof(wires));
+
+	for (s = 0; s < DECODE_SAMPLE_COUNT; s++) {
+		samples[s] = _sample_new(s);
+		if (!samples[s]
+			|| !dbus_message_marshal(samples[s],
+						&wires[s], &lens[s])) {
+			fprintf(stderr, "fail to build sample message\n");
+			ret = -1;
+			goto out;
+		}
+	}
+
+	start = _now();
+	for (i = 0; i < count; i++) {
+		s = i % DECODE_SAMPLE_COUNT;
+		msg = samples[s];
+		if (wire) {
+			msg = dbus_message_demarshal(wires[s], lens[s], NULL);
+			if (!msg) {
+				failed++;
+				continue;
+			}
+		}
+
+		if (!_minictrl_event_decode(msg,
+			g_signals[s % DECODE_SIGNAL_COUNT].action, &event))
+			_consume(&event);
+		else
+			failed++;
+
+		if (wire)
+			dbus_message_unref(msg);
+	}
+	elapsed = _now() - start;
+
+	printf("messages decoded : %lu (%lu failed)\n", count, failed);
+	printf("wall time        : %.3f s\n", elapsed);
+	if (elapsed > 0.0) {
+		printf("throughput       : %.0f msgs/s\n", count / elapsed);
+		printf("per message      : %.1f ns\n", elapsed / count * 1e9);
+	}
+
+out:
+	for (s = 0; s < DECODE_SAMPLE_COUNT; s++) {
+		if (samples[s])
+			dbus_message_unref(samples[s]);
+		dbus_free(wires[s]);
+	}
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long count = 0;
+	int wire = 0;
+	int ret = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:w")) != -1) {
+		switch (opt) {
+		case 'n':
+			count = strtoul(optarg, NULL, 10);
+			break;
+		case 'w':
+			wire = 1;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n count] [-w] [input...]\n",
+					argv[0]);
+			return 1;
+		}
+	}
+
+	if (!count && optind >= argc) {
+		fprintf(stderr, "usage: %s [-n count] [-w] [input...]\n",
+				argv[0]);
+		return 1;
+	}
+
+	for (; optind < argc; optind++) {
+		if (_decode_file(argv[optind]) < 0)
+			ret = 1;
+	}
+
+	if (count && _throughput(count, wire) < 0)
+		ret = 1;
+
+	return ret;
+}
+#endif /* MINICTRL_DECODE_FUZZER */
@@ -0,0 +1,423 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Replays a trace recorded with MINICONTROL_TRACE against the bus and
+ * reports monitor callback latency and CPU time. Run it against a
+ * private daemon by pointing MINICONTROL_BUS at its address. Run it again
+ * with MINICONTROL_MAINLOOP=glib to compare dispatch through dbus-glib.
+ *
+ * Only records of one direction are replayed, a signal a process sent
+ * and received itself would go out twice otherwise. By default these are
+ * the received records if the trace has any (a monitor trace), else the
+ * sent ones (a provider trace).
+ *
+ * usage: minicontrol-replay [-s speed] [-m] [-d recv|send] trace
+ *   -s speed : replay speed factor, 0 sends as fast as possible (default 1)
+ *   -m       : do not start a monitor, only send the recorded events
+ *   -d dir   : replay the records of this direction only
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <Ecore.h>
+
+#include "minicontrol-error.h"
+#include "minicontrol-internal.h"
+#include "minicontrol-monitor.h"
+#include "minicontrol-trace.h"
+
+#define REPLAY_NAME_MAX 1024
+#define REPLAY_DRAIN_TIMEOUT 1.0
+#define REPLAY_USAGE "usage: %s [-s speed] [-m] [-d recv|send] trace\n"
+
+struct replay_event {
+	double when;
+	int dir;
+	int signal;
+	char *name;
+	unsigned int width;
+	unsigned int height;
+	unsigned int priority;
+	double sent;
+	int matched;
+	int name_next; /* next event of the same name, -1 at the end */
+};
+
+/* events of one name, callbacks are matched from the oldest unmatched */
+struct replay_name {
+	int head;
+	int tail;
+};
+
+static struct replay_event *g_events;
+static int g_event_count;
+static int g_next;
+static int g_dir = -1;
+static Eina_Hash *g_names;
+static double g_speed = 1.0;
+static double g_start;
+static double *g_latency;
+static int g_latency_count;
+static int g_callback_count;
+
+static int _action_to_signal(minicontrol_action_e action)
+{
+	switch (action) {
+	case MINICONTROL_ACTION_START:
+		return MINICTRL_TRACE_SIG_START;
+	case MINICONTROL_ACTION_STOP:
+		return MINICTRL_TRACE_SIG_STOP;
+	case MINICONTROL_ACTION_RESIZE:
+		return MINICTRL_TRACE_SIG_RESIZE;
+	case MINICONTROL_ACTION_PRIORITY:
+		return MINICTRL_TRACE_SIG_PRIORITY;
+	default:
+		return MINICTRL_TRACE_SIG_UNKNOWN;
+	}
+}
+
+static void _monitor_cb(minicontrol_action_e action, const char *name,
+			unsigned int width, unsigned int height,
+			minicontrol_priority_e priority, void *data)
+{
+	double now = ecore_time_get();
+	int signal = _action_to_signal(action);
+	struct replay_name *key;
+	int i;
+
+	g_callback_count++;
+
+	key = eina_hash_find(g_names, name);
+	if (!key)
+		return;
+
+	/* events before head are matched or were coalesced away */
+	while (key->head >= 0 && g_events[key->head].matched)
+		key->head = g_events[key->head].name_next;
+
+	for (i = key->head; i >= 0 && i < g_next; i = g_events[i].name_next) {
+		struct replay_event *ev = &g_events[i];
+
+		if (ev->matched || ev->signal != signal)
+			continue;
+
+		ev->matched = 1;
+		g_latency[g_latency_count++] = now - ev->sent;
+		break;
+	}
+}
+
+static int _index(void)
+{
+	struct replay_name *key;
+	int i;
+
+	g_names = eina_hash_string_superfast_new(free);
+	if (!g_names)
+		return -1;
+
+	for (i = 0; i < g_event_count; i++) {
+		g_events[i].name_next = -1;
+
+		key = eina_hash_find(g_names, g_events[i].name);
+		if (key) {
+			g_events[key->tail].name_next = i;
+			key->tail = i;
+			continue;
+		}
+
+		key = malloc(sizeof(struct replay_name));
+		if (!key)
+			return -1;
+		key->head = i;
+		key->tail = i;
+		eina_hash_add(g_names, g_events[i].name, key);
+	}
+
+	return 0;
+}
+
+/* keeps the events of the replayed direction only */
+static void _filter(void)
+{
+	double first = 0.0;
+	int dir = g_dir;
+	int n = 0;
+	int i;
+
+	if (dir < 0) {
+		dir = MINICTRL_TRACE_DIR_SEND;
+		for (i = 0; i < g_event_count; i++) {
+			if (g_events[i].dir == MINICTRL_TRACE_DIR_RECV) {
+				dir = MINICTRL_TRACE_DIR_RECV;
+				break;
+			}
+		}
+	}
+
+	for (i = 0; i < g_event_count; i++) {
+		if (g_events[i].dir != dir) {
+			free(g_events[i].name);
+			continue;
+		}
+
+		if (!n)
+			first = g_events[i].when;
+
+		g_events[n] = g_events[i];
+		g_events[n].when -= first;
+		n++;
+	}
+
+	printf("replaying %d of %d %s records\n", n, g_event_count,
+			dir == MINICTRL_TRACE_DIR_RECV ? "received" : "sent");
+	g_event_count = n;
+}
+
+static int _load(const char *path)
+{
+	struct _minictrl_trace_record rec;
+	char name[REPLAY_NAME_MAX];
+	uint64_t first = 0;
+	int size = 0;
+	FILE *fp;
+
+	fp = fopen(path, "rb");
+	if (!fp) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return -1;
+	}
+
+	if (_minictrl_trace_read_header(fp) != MINICONTROL_ERROR_NONE) {
+		fprintf(stderr, "%s is not a minicontrol trace\n", path);
+		fclose(fp);
+		return -1;
+	}
+
+	while (_minictrl_trace_read(fp, &rec, name, sizeof(name))
+					== MINICONTROL_ERROR_NONE) {
+		struct replay_event *ev;
+
+		if (rec.signal == MINICTRL_TRACE_SIG_UNKNOWN)
+			continue;
+
+		if (g_event_count == size) {
+			size = size ? size * 2 : 256;
+			g_events = realloc(g_events,
+					sizeof(struct replay_event) * size);
+			if (!g_events) {
+				fclose(fp);
+				return -1;
+			}
+		}
+
+		if (!g_event_count)
+			first = rec.timestamp;
+
+		ev = &g_events[g_event_count++];
+		ev->when = (rec.timestamp - first) / 1000000.0;
+		ev->dir = rec.dir;
+		ev->signal = rec.signal;
+		ev->name = strdup(name);
+		ev->width = rec.width;
+		ev->height = rec.height;
+		ev->priority = rec.priority;
+		ev->sent = 0.0;
+		ev->matched = 0;
+	}
+
+	fclose(fp);
+
+	_filter();
+	if (_index() < 0)
+		return -1;
+
+	g_latency = calloc(g_event_count + 1, sizeof(double));
+
+	return g_latency ? 0 : -1;
+}
+
+static void _send(struct replay_event *ev)
+{
+	ev->sent = ecore_time_get();
+
+	if (ev->signal == MINICTRL_TRACE_SIG_RUNNING_REQ)
+		_minictrl_viewer_req_message_send();
+	else if (ev->signal == MINICTRL_TRACE_SIG_PRIORITY)
+		_minictrl_provider_priority_message_send(ev->name,
+						ev->priority);
+	else
+		_minictrl_provider_message_send(
+				_minictrl_trace_sig_name(ev->signal),
+				ev->name, ev->width, ev->height,
+				ev->priority);
+}
+
+static Eina_Bool _quit_cb(void *data)
+{
+	ecore_main_loop_quit();
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool _replay_cb(void *data)
+{
+	double elapsed;
+
+	while (g_next < g_event_count) {
+		struct replay_event *ev = &g_events[g_next];
+
+		elapsed = ecore_time_get() - g_start;
+		if (g_speed > 0.0 && ev->when / g_speed > elapsed) {
+			ecore_timer_add(ev->when / g_speed - elapsed,
+					_replay_cb, NULL);
+			return ECORE_CALLBACK_CANCEL;
+		}
+
+		_send(ev);
+		g_next++;
+	}
+
+	ecore_timer_add(REPLAY_DRAIN_TIMEOUT, _quit_cb, NULL);
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static int _cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static double _rusage_sec(void)
+{
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+
+	return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+		+ (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000000.0;
+}
+
+static void _report(double wall, double cpu)
+{
+	double sum = 0.0;
+	int i;
+
+	printf("events replayed : %d\n", g_event_count);
+	printf("callbacks       : %d (%d matched)\n",
+			g_callback_count, g_latency_count);
+	printf("wall time       : %.3f s\n", wall);
+	printf("cpu time        : %.3f s\n", cpu);
+
+	if (!g_latency_count)
+		return;
+
+	qsort(g_latency, g_latency_count, sizeof(double), _cmp_double);
+	for (i = 0; i < g_latency_count; i++)
+		sum += g_latency[i];
+
+	printf("latency avg     : %.1f us\n", sum / g_latency_count * 1e6);
+	printf("latency p50     : %.1f us\n",
+			g_latency[g_latency_count / 2] * 1e6);
+	printf("latency p99     : %.1f us\n",
+			g_latency[g_latency_count * 99 / 100] * 1e6);
+	printf("latency max     : %.1f us\n",
+			g_latency[g_latency_count - 1] * 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *env;
+	int monitor = 1;
+	double cpu;
+	int opt;
+	int i;
+
+	while ((opt = getopt(argc, argv, "s:md:")) != -1) {
+		switch (opt) {
+		case 's':
+			g_speed = atof(optarg);
+			break;
+		case 'm':
+			monitor = 0;
+			break;
+		case 'd':
+			if (!strcmp(optarg, "recv")) {
+				g_dir = MINICTRL_TRACE_DIR_RECV;
+				break;
+			}
+			if (!strcmp(optarg, "send")) {
+				g_dir = MINICTRL_TRACE_DIR_SEND;
+				break;
+			}
+			/* fall through */
+		default:
+			fprintf(stderr, REPLAY_USAGE, argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, REPLAY_USAGE, argv[0]);
+		return 1;
+	}
+
+	ecore_init();
+
+	if (_load(argv[optind]) < 0) {
+		ecore_shutdown();
+		return 1;
+	}
+	/* the Ecore native path is measured without the GLib bridge */
+	env = getenv("MINICONTROL_MAINLOOP");
+	if (env && !strcmp(env, "glib"))
+		ecore_main_loop_glib_integrate();
+
+	if (monitor && minicontrol_monitor_start(_monitor_cb, NULL)
+					!= MINICONTROL_ERROR_NONE) {
+		fprintf(stderr, "fail to start monitor\n");
+		return 1;
+	}
+
+	cpu = _rusage_sec();
+	g_start = ecore_time_get();
+	ecore_timer_add(0.0, _replay_cb, NULL);
+
+	ecore_main_loop_begin();
+
+	_report(ecore_time_get() - g_start - REPLAY_DRAIN_TIMEOUT,
+			_rusage_sec() - cpu);
+
+	if (monitor)
+		minicontrol_monitor_stop();
+
+	eina_hash_free(g_names);
+	for (i = 0; i < g_event_count; i++)
+		free(g_events[i].name);
+	free(g_events);
+	free(g_latency);
+
+	ecore_shutdown();
+
+	return 0;
+}
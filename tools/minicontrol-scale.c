@@ -0,0 +1,443 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Starts provider windows in steps of 1, 2, 4, ... up to a maximum and
+ * reports how the library scales. For each step, it reports:
+ *   - the time until the monitor saw every START
+ *   - the time until every window answered a RUNNING_REQ
+ *   - the CPU time of the monitor
+ *   - the heap and connections held per provider window
+ *   - the match rules on the daemon
+ * Windows are created by child processes on the buffer engine, so no
+ * display is needed. Run it against a private daemon:
+ *
+ *   eval $(dbus-daemon --session --fork --print-address=1 | \
+ *		sed 's/^/export MINICONTROL_BUS=/')
+ *
+ * Match rules are read from org.freedesktop.DBus.Debug.Stats and are
+ * only reported if the daemon was built with statistics.
+ *
+ * usage: minicontrol-scale [-n windows] [-p processes] [-t timeout]
+ *   -n windows   : maximum number of provider windows (default 1024)
+ *   -p processes : maximum number of provider processes (default 16)
+ *   -t timeout   : seconds to wait for each phase of a step (default 30)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <Elementary.h>
+#include <dbus/dbus.h>
+
+#include "minicontrol-error.h"
+#include "minicontrol-internal.h"
+#include "minicontrol-monitor.h"
+#include "minicontrol-provider.h"
+
+#define SCALE_PROC_MAX 256
+#define SCALE_CHILD_OPT "-C"
+
+struct scale_child {
+	pid_t pid;
+	int fd;
+	int windows;
+};
+
+static struct scale_child g_children[SCALE_PROC_MAX];
+static int g_child_count;
+static int g_expected;
+static int g_started;
+static int g_stopped;
+static double g_timeout = 30.0;
+
+static void _monitor_cb(minicontrol_action_e action, const char *name,
+			unsigned int width, unsigned int height,
+			minicontrol_priority_e priority, void *data)
+{
+	if (action == MINICONTROL_ACTION_START)
+		g_started++;
+	else if (action == MINICONTROL_ACTION_STOP)
+		g_stopped++;
+	else
+		return;
+
+	if (g_started == g_expected || g_stopped == g_expected)
+		ecore_main_loop_quit();
+}
+
+static Eina_Bool _timeout_cb(void *data)
+{
+	int *expired = data;
+
+	*expired = 1;
+	ecore_main_loop_quit();
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+/* runs the main loop until *count reaches g_expected, returns seconds */
+static double _wait_for(int *count)
+{
+	Ecore_Timer *timer;
+	double start = ecore_time_get();
+	int expired = 0;
+
+	if (*count < g_expected) {
+		timer = ecore_timer_add(g_timeout, _timeout_cb, &expired);
+		while (*count < g_expected && !expired)
+			ecore_main_loop_begin();
+		if (!expired)
+			ecore_timer_del(timer);
+	}
+
+	if (expired)
+		return -1.0;
+
+	return ecore_time_get() - start;
+}
+
+static double _rusage_sec(void)
+{
+	struct rusage ru;
+
+	getrusage(RUSAGE_SELF, &ru);
+
+	return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+		+ (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000000.0;
+}
+
+static DBusConnection *_bus_get(void)
+{
+	const char *env = getenv("MINICONTROL_BUS");
+	DBusConnection *conn;
+
+	if (!env || !env[0] || !strcmp(env, "system"))
+		return dbus_bus_get_private(DBUS_BUS_SYSTEM, NULL);
+
+	if (!strcmp(env, "session"))
+		return dbus_bus_get_private(DBUS_BUS_SESSION, NULL);
+
+	conn = dbus_connection_open_private(env, NULL);
+	if (conn && !dbus_bus_register(conn, NULL)) {
+		dbus_connection_close(conn);
+		dbus_connection_unref(conn);
+		return NULL;
+	}
+
+	return conn;
+}
+
+/* returns -1 if the daemon does not keep statistics */
+static long _match_rules_get(DBusConnection *conn)
+{
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	DBusMessageIter entry;
+	DBusMessageIter value;
+	DBusMessage *msg;
+	DBusMessage *reply;
+	const char *key;
+	dbus_uint32_t rules;
+	long ret = -1;
+
+	if (!conn)
+		return -1;
+
+	msg = dbus_message_new_method_call("org.freedesktop.DBus",
+				"/org/freedesktop/DBus",
+				"org.freedesktop.DBus.Debug.Stats", "GetStats");
+	if (!msg)
+		return -1;
+
+	reply = dbus_connection_send_with_reply_and_block(conn, msg,
+							1000, NULL);
+	dbus_message_unref(msg);
+	if (!reply)
+		return -1;
+
+	if (!dbus_message_iter_init(reply, &iter)
+		|| dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_ARRAY)
+		goto out;
+
+	dbus_message_iter_recurse(&iter, &dict);
+	while (dbus_message_iter_get_arg_type(&dict) == DBUS_TYPE_DICT_ENTRY) {
+		dbus_message_iter_recurse(&dict, &entry);
+		dbus_message_iter_get_basic(&entry, &key);
+		dbus_message_iter_next(&entry);
+		dbus_message_iter_recurse(&entry, &value);
+
+		if (!strcmp(key, "MatchRules")
+			&& dbus_message_iter_get_arg_type(&value)
+					== DBUS_TYPE_UINT32) {
+			dbus_message_iter_get_basic(&value, &rules);
+			ret = rules;
+			break;
+		}
+		dbus_message_iter_next(&dict);
+	}
+
+out:
+	dbus_message_unref(reply);
+
+	return ret;
+}
+
+static int _spawn(const char *self, int index, int windows)
+{
+	struct scale_child *child = &g_children[index];
+	char count[16];
+	int fds[2];
+
+	if (pipe(fds) < 0)
+		return -1;
+
+	child->pid = fork();
+	if (child->pid < 0) {
+		close(fds[0]);
+		close(fds[1]);
+		return -1;
+	}
+
+	if (!child->pid) {
+		/* the child reports its resources on stdout */
+		close(fds[0]);
+		dup2(fds[1], STDOUT_FILENO);
+		close(fds[1]);
+
+		snprintf(count, sizeof(count), "%d", windows);
+		execl(self, self, SCALE_CHILD_OPT, count, (char *)NULL);
+		_exit(127);
+	}
+
+	close(fds[1]);
+	child->fd = fds[0];
+	child->windows = windows;
+
+	return 0;
+}
+
+static void _reap(void)
+{
+	int i;
+
+	for (i = 0; i < g_child_count; i++) {
+		kill(g_children[i].pid, SIGTERM);
+		waitpid(g_children[i].pid, NULL, 0);
+		close(g_children[i].fd);
+	}
+
+	g_child_count = 0;
+}
+
+static int _step(const char *self, DBusConnection *conn,
+			int windows, int procs)
+{
+	minicontrol_resource_s res;
+	unsigned long bytes = 0;
+	unsigned int conns = 0;
+	double start_time;
+	double req_time;
+	double stop_time;
+	double cpu;
+	long rules;
+	int share;
+	int i;
+
+	if (procs > windows)
+		procs = windows;
+
+	g_expected = windows;
+	g_started = 0;
+	g_stopped = 0;
+	cpu = _rusage_sec();
+
+	for (i = 0; i < procs; i++) {
+		share = windows / procs + (i < windows % procs);
+		if (_spawn(self, i, share) < 0) {
+			fprintf(stderr, "fail to spawn provider\n");
+			_reap();
+			return -1;
+		}
+		g_child_count++;
+	}
+
+	start_time = _wait_for(&g_started);
+
+	for (i = 0; i < g_child_count; i++) {
+		if (read(g_children[i].fd, &res, sizeof(res)) != sizeof(res))
+			continue;
+		bytes += res.bytes;
+		conns += res.connection_count;
+	}
+
+	rules = _match_rules_get(conn);
+
+	/* every running window answers with START */
+	g_started = 0;
+	_minictrl_viewer_req_message_send();
+	req_time = _wait_for(&g_started);
+
+	cpu = _rusage_sec() - cpu;
+
+	_reap();
+	stop_time = _wait_for(&g_stopped);
+
+	printf("%8d %6d %10.1f %10.1f %10.1f %10.1f %12lu %8.2f %8ld\n",
+		windows, procs, start_time * 1000.0, req_time * 1000.0,
+		stop_time * 1000.0, cpu * 1000.0,
+		bytes / windows, (double)conns / procs, rules);
+	fflush(stdout);
+
+	return start_time < 0.0 || req_time < 0.0 || stop_time < 0.0;
+}
+
+static Eina_Bool _child_exit_cb(void *data, int type, void *event)
+{
+	ecore_main_loop_quit();
+
+	return ECORE_CALLBACK_PASS_ON;
+}
+
+static Eina_Bool _child_report_cb(void *data)
+{
+	minicontrol_resource_s res;
+
+	memset(&res, 0, sizeof(res));
+	minicontrol_provider_resource_get(&res);
+	if (write(STDOUT_FILENO, &res, sizeof(res)) != sizeof(res))
+		ecore_main_loop_quit();
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+static int _child(int windows)
+{
+	Evas_Object **wins;
+	char name[64];
+	int i;
+
+	setenv("ELM_ENGINE", "buffer", 1);
+	elm_init(0, NULL);
+
+	wins = calloc(windows, sizeof(Evas_Object *));
+	if (!wins)
+		return 1;
+
+	for (i = 0; i < windows; i++) {
+		snprintf(name, sizeof(name), "scale-%d-%d", getpid(), i);
+		wins[i] = minicontrol_win_add(name);
+		if (!wins[i])
+			continue;
+		evas_object_resize(wins[i], 480, 100);
+		evas_object_show(wins[i]);
+	}
+
+	ecore_event_handler_add(ECORE_EVENT_SIGNAL_EXIT, _child_exit_cb, NULL);
+	/* report once the STARTs are sent */
+	ecore_timer_add(0.0, _child_report_cb, NULL);
+	ecore_main_loop_begin();
+
+	for (i = 0; i < windows; i++) {
+		if (wins[i])
+			evas_object_del(wins[i]);
+	}
+	free(wins);
+
+	elm_shutdown();
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	DBusConnection *conn;
+	int max_windows = 1024;
+	int max_procs = 16;
+	int windows;
+	int ret = 0;
+	int opt;
+
+	if (argc == 3 && !strcmp(argv[1], SCALE_CHILD_OPT))
+		return _child(atoi(argv[2]));
+
+	while ((opt = getopt(argc, argv, "n:p:t:")) != -1) {
+		switch (opt) {
+		case 'n':
+			max_windows = atoi(optarg);
+			break;
+		case 'p':
+			max_procs = atoi(optarg);
+			break;
+		case 't':
+			g_timeout = atof(optarg);
+			break;
+		default:
+			fprintf(stderr,
+				"usage: %s [-n windows] [-p processes] [-t timeout]\n",
+				argv[0]);
+			return 1;
+		}
+	}
+
+	if (max_windows < 1 || max_procs < 1 || max_procs > SCALE_PROC_MAX) {
+		fprintf(stderr, "windows must be > 0, processes 1..%d\n",
+				SCALE_PROC_MAX);
+		return 1;
+	}
+
+	ecore_init();
+
+	if (minicontrol_monitor_start(_monitor_cb, NULL)
+					!= MINICONTROL_ERROR_NONE) {
+		fprintf(stderr, "fail to start monitor\n");
+		return 1;
+	}
+
+	conn = _bus_get();
+
+	printf("%8s %6s %10s %10s %10s %10s %12s %8s %8s\n",
+		"windows", "procs", "start ms", "req ms", "stop ms",
+		"cpu ms", "bytes/win", "conn/proc", "rules");
+
+	for (windows = 1; !ret; windows *= 2) {
+		if (windows > max_windows)
+			windows = max_windows;
+
+		ret = _step("/proc/self/exe", conn, windows, max_procs);
+		if (ret)
+			fprintf(stderr, "step of %d windows timed out\n",
+					windows);
+
+		if (windows == max_windows)
+			break;
+	}
+
+	if (conn) {
+		dbus_connection_close(conn);
+		dbus_connection_unref(conn);
+	}
+
+	minicontrol_monitor_stop();
+	ecore_shutdown();
+
+	return ret;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Creates and destroys provider windows, viewers and a monitor in a loop
+ * and checks that the resources reported by each library return to
+ * their baseline. The baseline is taken after one warm up cycle, which
+ * sets up connections and pools kept for the life of the process.
+ * Windows use the buffer engine, so no display is needed. Run it against
+ * a private daemon by pointing MINICONTROL_BUS at its address.
+ *
+ * usage: minicontrol-stress [-c cycles] [-n windows]
+ *   -c cycles  : number of create and destroy cycles (default 1000)
+ *   -n windows : provider windows and viewers per cycle (default 8)
+ *
+ * Exits with 1 and logs the counters of the leaking library if any
+ * counter differs from its baseline after a cycle.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <Elementary.h>
+
+#include "minicontrol-error.h"
+#include "minicontrol-monitor.h"
+#include "minicontrol-provider.h"
+#include "minicontrol-viewer.h"
+
+#define STRESS_SETTLE_ITERATIONS 16
+
+typedef minicontrol_error_e (*stress_resource_get)(minicontrol_resource_s *);
+
+struct stress_lib {
+	const char *name;
+	stress_resource_get get;
+	void (*dump)(void);
+	minicontrol_resource_s baseline;
+};
+
+static struct stress_lib g_libs[] = {
+	{ .name = "provider", .get = minicontrol_provider_resource_get,
+		.dump = minicontrol_provider_resource_dump },
+	{ .name = "monitor", .get = minicontrol_monitor_resource_get,
+		.dump = minicontrol_monitor_resource_dump },
+	{ .name = "viewer", .get = minicontrol_viewer_resource_get,
+		.dump = minicontrol_viewer_resource_dump },
+};
+
+#define STRESS_LIB_COUNT (int)(sizeof(g_libs) / sizeof(g_libs[0]))
+
+static void _monitor_cb(minicontrol_action_e action, const char *name,
+			unsigned int width, unsigned int height,
+			minicontrol_priority_e priority, void *data)
+{
+}
+
+/* lets queued signals, timers and idlers of the libraries run */
+static void _settle(void)
+{
+	int i;
+
+	for (i = 0; i < STRESS_SETTLE_ITERATIONS; i++)
+		ecore_main_loop_iterate();
+}
+
+static int _cycle(Evas_Object *parent, int windows, int cycle)
+{
+	Evas_Object **wins;
+	Evas_Object **viewers;
+	char name[64];
+	int ret = 0;
+	int i;
+
+	wins = calloc(windows, sizeof(Evas_Object *));
+	viewers = calloc(windows, sizeof(Evas_Object *));
+	if (!wins || !viewers) {
+		free(wins);
+		free(viewers);
+		return -1;
+	}
+
+	if (minicontrol_monitor_start(_monitor_cb, NULL)
+					!= MINICONTROL_ERROR_NONE) {
+		fprintf(stderr, "cycle %d: fail to start monitor\n", cycle);
+		ret = -1;
+	}
+
+	for (i = 0; i < windows; i++) {
+		snprintf(name, sizeof(name), "stress-%d-%d", getpid(), i);
+		wins[i] = minicontrol_win_add(name);
+		if (!wins[i]) {
+			fprintf(stderr, "cycle %d: fail to add window %d\n",
+					cycle, i);
+			ret = -1;
+			continue;
+		}
+		evas_object_resize(wins[i], 480, 100);
+		evas_object_show(wins[i]);
+	}
+
+	_settle();
+
+	/* a viewer of a window that failed to start is still added */
+	for (i = 0; i < windows; i++) {
+		snprintf(name, sizeof(name), "stress-%d-%d", getpid(), i);
+		viewers[i] = minicontrol_viewer_add(parent, name);
+	}
+
+	_settle();
+
+	for (i = 0; i < windows; i++) {
+		if (viewers[i])
+			evas_object_del(viewers[i]);
+		if (wins[i])
+			evas_object_del(wins[i]);
+	}
+
+	minicontrol_monitor_stop();
+
+	_settle();
+
+	free(wins);
+	free(viewers);
+
+	return ret;
+}
+
+static int _check(int cycle)
+{
+	minicontrol_resource_s res;
+	struct stress_lib *lib;
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < STRESS_LIB_COUNT; i++) {
+		lib = &g_libs[i];
+
+		memset(&res, 0, sizeof(res));
+		lib->get(&res);
+
+		if (!memcmp(&res, &lib->baseline, sizeof(res)))
+			continue;
+
+		fprintf(stderr, "cycle %d: %s resources differ from baseline\n"
+			"  providers %u/%u handles %u/%u connections %u/%u"
+			" matches %u/%u names %u/%u fds %u/%u bytes %lu/%lu\n",
+			cycle, lib->name,
+			res.provider_count, lib->baseline.provider_count,
+			res.handle_count, lib->baseline.handle_count,
+			res.connection_count, lib->baseline.connection_count,
+			res.match_count, lib->baseline.match_count,
+			res.plug_name_count, lib->baseline.plug_name_count,
+			res.fd_count, lib->baseline.fd_count,
+			res.bytes, lib->baseline.bytes);
+		lib->dump();
+		ret = -1;
+	}
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	Evas_Object *parent;
+	int cycles = 1000;
+	int windows = 8;
+	int ret = 0;
+	int opt;
+	int i;
+
+	while ((opt = getopt(argc, argv, "c:n:")) != -1) {
+		switch (opt) {
+		case 'c':
+			cycles = atoi(optarg);
+			break;
+		case 'n':
+			windows = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-c cycles] [-n windows]\n",
+					argv[0]);
+			return 1;
+		}
+	}
+
+	if (cycles < 1 || windows < 1) {
+		fprintf(stderr, "cycles and windows must be > 0\n");
+		return 1;
+	}
+
+	setenv("ELM_ENGINE", "buffer", 1);
+	elm_init(argc, argv);
+
+	parent = elm_win_add(NULL, "minicontrol-stress", ELM_WIN_BASIC);
+	if (!parent) {
+		fprintf(stderr, "fail to add viewer window\n");
+		elm_shutdown();
+		return 1;
+	}
+
+	/* warm up, connections and pools stay for the life of the process */
+	if (_cycle(parent, windows, 0) < 0) {
+		evas_object_del(parent);
+		elm_shutdown();
+		return 1;
+	}
+
+	for (i = 0; i < STRESS_LIB_COUNT; i++)
+		g_libs[i].get(&g_libs[i].baseline);
+
+	for (i = 1; i <= cycles && !ret; i++) {
+		ret = _cycle(parent, windows, i);
+		if (!ret)
+			ret = _check(i);
+	}
+
+	if (!ret)
+		printf("%d cycles of %d windows, resources at baseline\n",
+				cycles, windows);
+
+	evas_object_del(parent);
+	elm_shutdown();
+
+	return ret ? 1 : 0;
+}